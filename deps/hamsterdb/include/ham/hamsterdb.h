@@ -1609,6 +1609,21 @@ ham_db_get_parameters(ham_db_t *db, ham_parameter_t *param);
 /** Parameter name for @ref ham_env_create_db; sets the key size */
 #define HAM_PARAM_RECORD_SIZE           0x00000108
 
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * sets the page replacement policy of the cache */
+#define HAM_PARAM_CACHE_POLICY          0x00000109
+
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * sets the maximum number of dirty pages before they are flushed */
+#define HAM_PARAM_CACHE_DIRTY_LIMIT     0x0000010a
+
+/** Value for @ref HAM_PARAM_CACHE_POLICY; least recently used (default) */
+#define HAM_CACHE_POLICY_LRU            0
+
+/** Value for @ref HAM_PARAM_CACHE_POLICY; scan resistant 2Q - pages which
+ * are used only once are evicted before pages which are used again */
+#define HAM_CACHE_POLICY_2Q             1
+
 /** Value for unlimited record sizes */
 #define HAM_RECORD_SIZE_UNLIMITED       ((ham_u32_t)-1)
 
@@ -18,6 +18,11 @@
  * linked list, and whenever a page is accessed it is removed and re-inserted
  * at the head. The tail therefore points to the page which was not used
  * in a long time, and is the primary candidate for purging.
+ *
+ * With the 2Q policy (HAM_CACHE_POLICY_2Q) pages start in the "cold" list
+ * and move to a separate "hot" list when they are accessed again. Cold
+ * pages are purged first, therefore a long scan which touches every page
+ * only once does not evict the btree pages used by point lookups.
  */
 
 #ifndef HAM_CACHE_H__
@@ -51,7 +56,9 @@ class Cache
             ham_u64_t capacity_bytes = HAM_DEFAULT_CACHESIZE)
       : m_env(env), m_capacity(capacity_bytes), m_cur_elements(0),
         m_alloc_elements(0), m_totallist(0), m_totallist_tail(0),
-        m_cache_hits(0), m_cache_misses(0) {
+        m_hotlist(0), m_hotlist_tail(0), m_hot_elements(0),
+        m_policy(env->get_cache_policy()), m_cache_hits(0),
+        m_cache_misses(0) {
       if (m_capacity == 0)
         m_capacity = HAM_DEFAULT_CACHESIZE;
 
@@ -78,8 +85,11 @@ class Cache
 
       // Now re-insert the page at the head of the "totallist", and
       // thus move far away from the tail. The pages at the tail are highest
-      // candidates to be deleted when the cache is purged.
+      // candidates to be deleted when the cache is purged. With the 2Q
+      // policy the page moves to the head of the "hotlist".
       remove_page(page);
+      if (m_policy == HAM_CACHE_POLICY_2Q)
+        page->set_cache_hot(true);
       put_page(page);
 
       m_cache_hits++;
@@ -99,13 +109,26 @@ class Cache
        * cache->_totallist_tail pointer is updated and that the page
        * is inserted at the HEAD of the list
        */
-      if (page->is_in_list(m_totallist, Page::kListCache))
+      if (page->is_in_list(list_head(page), Page::kListCache))
         remove_page(page);
 
       /* now (re-)insert into the list of all cached pages, and increment
        * the counter */
-      ham_assert(!page->is_in_list(m_totallist, Page::kListCache));
-      m_totallist = page->list_insert(m_totallist, Page::kListCache);
+      if (page->is_cache_hot()) {
+        ham_assert(!page->is_in_list(m_hotlist, Page::kListCache));
+        m_hotlist = page->list_insert(m_hotlist, Page::kListCache);
+        if (!m_hotlist_tail)
+          m_hotlist_tail = page;
+        m_hot_elements++;
+      }
+      else {
+        ham_assert(!page->is_in_list(m_totallist, Page::kListCache));
+        m_totallist = page->list_insert(m_totallist, Page::kListCache);
+
+        /* is this the chronologically oldest page? then set the pointer */
+        if (!m_totallist_tail)
+          m_totallist_tail = page;
+      }
 
       m_cur_elements++;
       if (page->get_flags() & Page::kNpersMalloc)
@@ -121,10 +144,6 @@ class Cache
         m_buckets[hash] = page->list_remove(m_buckets[hash], Page::kListBucket);
       ham_assert(!page->is_in_list(m_buckets[hash], Page::kListBucket));
       m_buckets[hash] = page->list_insert(m_buckets[hash], Page::kListBucket);
-
-      /* is this the chronologically oldest page? then set the pointer */
-      if (!m_totallist_tail)
-        m_totallist_tail = page;
     }
 
     // Removes a page from the cache
@@ -135,6 +154,8 @@ class Cache
        * update the pointer with the next oldest page */
       if (m_totallist_tail == page)
         m_totallist_tail = page->get_previous(Page::kListCache);
+      if (m_hotlist_tail == page)
+        m_hotlist_tail = page->get_previous(Page::kListCache);
 
       /* remove the page from the cache buckets */
       if (page->get_address()) {
@@ -146,7 +167,15 @@ class Cache
       }
 
       /* remove it from the list of all cached pages */
-      if (page->is_in_list(m_totallist, Page::kListCache)) {
+      if (page->is_cache_hot()) {
+        if (page->is_in_list(m_hotlist, Page::kListCache)) {
+          m_hotlist = page->list_remove(m_hotlist, Page::kListCache);
+          m_hot_elements--;
+          removed = true;
+        }
+        page->set_cache_hot(false);
+      }
+      else if (page->is_in_list(m_totallist, Page::kListCache)) {
         m_totallist = page->list_remove(m_totallist, Page::kListCache);
         removed = true;
       }
@@ -167,29 +196,31 @@ class Cache
 
       unsigned i = 0;
 
-      /* get the chronologically oldest page */
-      Page *oldest = m_totallist_tail;
-      if (!oldest)
-        return;
-
-      /* now iterate through all pages, starting from the oldest
-       * (which is the tail of the "totallist", the list of ALL cached
-       * pages) */
-      Page *page = oldest;
-      do {
-        /* pick the first unused page (not in a changeset) that is NOT mapped */
-        if (page->get_flags() & Page::kNpersMalloc
-            && !m_env->get_changeset().contains(page)) {
-          Page *prev = page->get_previous(Page::kListCache);
-          remove_page(page);
-          cb(page, pm);
-          i++;
-          page = prev;
+      if (m_policy == HAM_CACHE_POLICY_2Q) {
+        /* the hot pages may use up to 3/4 of the capacity; pages which were
+         * used only once are purged first */
+        ham_u64_t max_hot = (m_capacity / m_env->get_page_size()) / 4 * 3;
+        if (m_hot_elements > max_hot) {
+          ham_u64_t excess = m_hot_elements - max_hot;
+          i += purge_list(m_hotlist_tail, cb, pm,
+                  excess < limit ? (unsigned)excess : limit);
         }
-        else
-          page = page->get_previous(Page::kListCache);
-        ham_assert(page != oldest);
-      } while (i < limit && page && page != oldest);
+        if (i < limit)
+          i += purge_list(m_totallist_tail, cb, pm, limit - i);
+        if (i < limit)
+          i += purge_list(m_hotlist_tail, cb, pm, limit - i);
+      }
+      else
+        purge_list(m_totallist_tail, cb, pm, limit);
+    }
+
+    // Flushes up to |limit| dirty pages, starting with the oldest ones; the
+    // callback is called for every page that needs to be flushed. The pages
+    // remain in the cache
+    void flush_dirty(PurgeCallback cb, PageManager *pm, unsigned limit) {
+      unsigned i = flush_list(m_totallist_tail, cb, pm, limit);
+      if (i < limit)
+        flush_list(m_hotlist_tail, cb, pm, limit - i);
     }
 
     // the visitor callback returns true if the page should be removed from
@@ -199,16 +230,8 @@ class Cache
     // Visits all pages in the "totallist"; this is used by the Environment
     // to flush (and delete) pages
     void visit(VisitCallback cb, Database *db, ham_u32_t flags) {
-      Page *head = m_totallist;
-      while (head) {
-        Page *next = head->get_next(Page::kListCache);
-
-        if (cb(head, db, flags)) {
-          remove_page(head);
-          delete head;
-        }
-        head = next;
-      }
+      visit_list(m_totallist, cb, db, flags);
+      visit_list(m_hotlist, cb, db, flags);
     }
 
     // Returns true if the caller should purge the cache
@@ -242,6 +265,58 @@ class Cache
       return (o % kBucketSize);
     }
 
+    // Returns the head of the list which stores |page|
+    Page *list_head(Page *page) const {
+      return (page->is_cache_hot() ? m_hotlist : m_totallist);
+    }
+
+    // Purges up to |limit| unused pages (not in a changeset) that are NOT
+    // mapped, starting at |page| and moving towards the head of the list
+    unsigned purge_list(Page *page, PurgeCallback cb, PageManager *pm,
+                    unsigned limit) {
+      unsigned i = 0;
+      while (i < limit && page) {
+        Page *prev = page->get_previous(Page::kListCache);
+        if (page->get_flags() & Page::kNpersMalloc
+            && !m_env->get_changeset().contains(page)) {
+          remove_page(page);
+          cb(page, pm);
+          i++;
+        }
+        page = prev;
+      }
+      return (i);
+    }
+
+    // Flushes up to |limit| dirty pages (not in a changeset), starting at
+    // |page| and moving towards the head of the list
+    unsigned flush_list(Page *page, PurgeCallback cb, PageManager *pm,
+                    unsigned limit) {
+      unsigned i = 0;
+      while (i < limit && page) {
+        if (page->is_dirty() && !m_env->get_changeset().contains(page)) {
+          cb(page, pm);
+          i++;
+        }
+        page = page->get_previous(Page::kListCache);
+      }
+      return (i);
+    }
+
+    // Visits all pages of a list, see visit()
+    void visit_list(Page *head, VisitCallback cb, Database *db,
+                    ham_u32_t flags) {
+      while (head) {
+        Page *next = head->get_next(Page::kListCache);
+
+        if (cb(head, db, flags)) {
+          remove_page(head);
+          delete head;
+        }
+        head = next;
+      }
+    }
+
     // Sets the HEAD of the global page list
     void set_totallist(Page *l) {
       m_totallist = l;
@@ -267,6 +342,18 @@ class Cache
     // and therefore the highest candidate for a flush
     Page *m_totallist_tail;
 
+    // linked list of pages which were used more than once (2Q policy)
+    Page *m_hotlist;
+
+    // the tail of the linked "hotlist"
+    Page *m_hotlist_tail;
+
+    // the current number of elements in the "hotlist"
+    ham_u64_t m_hot_elements;
+
+    // the page replacement policy
+    ham_u32_t m_policy;
+
     // the buckets - a linked list of Page pointers
     std::vector<Page *> m_buckets;
 
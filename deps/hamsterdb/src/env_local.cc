@@ -44,7 +44,9 @@ LocalEnvironment::get_btree_descriptor(int i)
 LocalEnvironment::LocalEnvironment()
   : Environment(), m_header(0), m_device(0), m_changeset(this),
     m_blob_manager(0), m_page_manager(0), m_journal(0), m_txn_id(0),
-    m_encryption_enabled(false), m_page_size(0)
+    m_encryption_enabled(false), m_page_size(0),
+    m_cache_policy(HAM_CACHE_POLICY_LRU), m_cache_dirty_limit(0),
+    m_dirty_pages(0)
 {
 }
 
@@ -143,6 +143,36 @@ class LocalEnvironment : public Environment
       return (m_encryption_key);
     }
 
+    // Sets the page replacement policy and the dirty page limit of the
+    // cache; must be called before the Environment is created or opened
+    void set_cache_policy(ham_u32_t policy, ham_u64_t dirty_limit) {
+      m_cache_policy = policy;
+      m_cache_dirty_limit = dirty_limit;
+    }
+
+    // Returns the page replacement policy of the cache
+    ham_u32_t get_cache_policy() const {
+      return (m_cache_policy);
+    }
+
+    // Returns the maximum number of dirty pages (0 means unlimited)
+    ham_u64_t get_cache_dirty_limit() const {
+      return (m_cache_dirty_limit);
+    }
+
+    // Returns the number of dirty pages
+    ham_u64_t get_dirty_pages() const {
+      return (m_dirty_pages);
+    }
+
+    // Called by the Page whenever its dirty state changes
+    void adjust_dirty_pages(bool dirty) {
+      if (dirty)
+        m_dirty_pages++;
+      else if (m_dirty_pages)
+        m_dirty_pages--;
+    }
+
     // Creates a new Environment (ham_env_create)
     virtual ham_status_t create(const char *filename, ham_u32_t flags,
                     ham_u32_t mode, ham_u32_t page_size, ham_u64_t cache_size,
@@ -236,6 +266,15 @@ class LocalEnvironment : public Environment
 
     // The page_size which was specified when the env was created
     ham_u32_t m_page_size;
+
+    // The page replacement policy of the cache
+    ham_u32_t m_cache_policy;
+
+    // The maximum number of dirty pages (0 means unlimited)
+    ham_u64_t m_cache_dirty_limit;
+
+    // The current number of dirty pages
+    ham_u64_t m_dirty_pages;
 };
 
 } // namespace hamsterdb
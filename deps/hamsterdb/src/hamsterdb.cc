@@ -326,6 +326,8 @@ ham_env_create(ham_env_t **henv, const char *filename,
   ham_u64_t cache_size = 0;
   ham_u16_t max_databases = 0;
   ham_u32_t timeout = 0;
+  ham_u32_t cache_policy = HAM_CACHE_POLICY_LRU;
+  ham_u64_t cache_dirty_limit = 0;
   std::string logdir;
   ham_u8_t *encryption_key = 0;
 
@@ -396,6 +398,17 @@ ham_env_create(ham_env_t **henv, const char *filename,
       case HAM_PARAM_LOG_DIRECTORY:
         logdir = (const char *)param->value;
         break;
+      case HAM_PARAM_CACHE_POLICY:
+        if (param->value != HAM_CACHE_POLICY_LRU
+            && param->value != HAM_CACHE_POLICY_2Q) {
+          ham_trace(("invalid cache policy %d", (int)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        cache_policy = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_CACHE_DIRTY_LIMIT:
+        cache_dirty_limit = param->value;
+        break;
       case HAM_PARAM_NETWORK_TIMEOUT_SEC:
         timeout = (ham_u32_t)param->value;
         break;
@@ -456,6 +469,7 @@ ham_env_create(ham_env_t **henv, const char *filename,
         lenv->set_log_directory(logdir);
       if (encryption_key)
         lenv->enable_encryption(encryption_key);
+      lenv->set_cache_policy(cache_policy, cache_dirty_limit);
     }
     else {
 #ifndef HAM_ENABLE_REMOTE
@@ -602,6 +616,8 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
 {
   ham_u64_t cache_size = 0;
   ham_u32_t timeout = 0;
+  ham_u32_t cache_policy = HAM_CACHE_POLICY_LRU;
+  ham_u64_t cache_dirty_limit = 0;
   std::string logdir;
   ham_u8_t *encryption_key = 0;
 
@@ -647,6 +663,17 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
       case HAM_PARAM_LOG_DIRECTORY:
         logdir = (const char *)param->value;
         break;
+      case HAM_PARAM_CACHE_POLICY:
+        if (param->value != HAM_CACHE_POLICY_LRU
+            && param->value != HAM_CACHE_POLICY_2Q) {
+          ham_trace(("invalid cache policy %d", (int)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        cache_policy = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_CACHE_DIRTY_LIMIT:
+        cache_dirty_limit = param->value;
+        break;
       case HAM_PARAM_NETWORK_TIMEOUT_SEC:
         timeout = (ham_u32_t)param->value;
         break;
@@ -687,6 +714,7 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
         lenv->set_log_directory(logdir);
       if (encryption_key)
         lenv->enable_encryption(encryption_key);
+      lenv->set_cache_policy(cache_policy, cache_dirty_limit);
     }
     else {
 #ifndef HAM_ENABLE_REMOTE
@@ -29,7 +29,7 @@ namespace hamsterdb {
 
 Page::Page(LocalEnvironment *env, LocalDatabase *db)
   : m_env(env), m_db(db), m_address(0), m_flags(0), m_dirty(false),
-    m_cursor_list(0), m_node_proxy(0), m_data(0)
+    m_cache_hot(false), m_cursor_list(0), m_node_proxy(0), m_data(0)
 {
   memset(&m_prev[0], 0, sizeof(m_prev));
   memset(&m_next[0], 0, sizeof(m_next));
@@ -37,6 +37,9 @@ Page::Page(LocalEnvironment *env, LocalDatabase *db)
 
 Page::~Page()
 {
+  if (m_env && m_dirty)
+    m_env->adjust_dirty_pages(false);
+
   if (m_env && m_env->get_device() && m_data != 0)
     m_env->get_device()->free_page(this);
 
@@ -49,6 +52,14 @@ Page::~Page()
   ham_assert(m_cursor_list == 0);
 }
 
+void
+Page::set_dirty(bool dirty)
+{
+  if (m_env && m_dirty != dirty)
+    m_env->adjust_dirty_pages(dirty);
+  m_dirty = dirty;
+}
+
 void
 Page::allocate(ham_u32_t type, ham_u32_t flags)
 {
@@ -194,8 +194,16 @@ class Page {
     }
 
     // Sets this page dirty/not dirty
-    void set_dirty(bool dirty) {
-      m_dirty = dirty;
+    void set_dirty(bool dirty);
+
+    // Returns true if the cache has seen this page more than once
+    bool is_cache_hot() const {
+      return (m_cache_hot);
+    }
+
+    // Marks this page as used more than once (used by the 2Q cache)
+    void set_cache_hot(bool hot) {
+      m_cache_hot = hot;
     }
 
     // Returns the linked list of coupled cursors (can be NULL)
@@ -353,6 +361,9 @@ class Page {
     // is this page dirty and needs to be flushed to disk?
     bool m_dirty;
 
+    // is this page in the cache's list of pages used more than once?
+    bool m_cache_hot;
+
     // linked list of all cursors which point to that page
     BtreeCursor *m_cursor_list;
 
@@ -421,11 +421,29 @@ PageManager::purge_callback(Page *page, PageManager *pm)
   delete page;
 }
 
+void
+PageManager::flush_dirty_callback(Page *page, PageManager *pm)
+{
+  pm->flush_page(page);
+}
+
 void
 PageManager::purge_cache()
 {
   // in-memory-db: don't remove the pages or they would be lost
-  if (m_env->get_flags() & HAM_IN_MEMORY || !m_cache.is_full())
+  if (m_env->get_flags() & HAM_IN_MEMORY)
+    return;
+
+  // Flush the oldest dirty pages if there are too many of them. The limit
+  // is exceeded by |kPurgeAtLeast| pages before flushing to batch the I/O.
+  ham_u64_t dirty_limit = m_env->get_cache_dirty_limit();
+  if (dirty_limit
+      && m_env->get_dirty_pages() > dirty_limit + kPurgeAtLeast) {
+    m_cache.flush_dirty(flush_dirty_callback, this,
+            (unsigned)(m_env->get_dirty_pages() - dirty_limit));
+  }
+
+  if (!m_cache.is_full())
     return;
 
   // Purge as many pages as possible to get memory usage down to the
@@ -198,6 +198,9 @@ class PageManager {
     // callback for purging pages
     static void purge_callback(Page *page, PageManager *pm);
 
+    // callback for flushing dirty pages
+    static void flush_dirty_callback(Page *page, PageManager *pm);
+
     // The current Environment handle
     LocalEnvironment *m_env;
 
@@ -59,6 +59,16 @@ namespace ht4c { namespace Common {
 	const char* Config::HamsterEnableAutoRecovery							= "Ht4n.Hamster.EnableAutoRecovery";
 	const char* Config::HamsterCacheSizeMB									= "Ht4n.Hamster.CacheSizeMB";
 	const char* Config::HamsterPageSizeKB									= "Ht4n.Hamster.PageSizeKB";
+	const char* Config::HamsterCacheScanResistant							= "Ht4n.Hamster.CacheScanResistant";
+	const char* Config::HamsterCacheDirtyPageLimit							= "Ht4n.Hamster.CacheDirtyPageLimit";
+	const char* Config::HamsterBinaryKeys									= "Ht4n.Hamster.BinaryKeys";
+	const char* Config::HamsterMigrateKeys									= "Ht4n.Hamster.MigrateKeys";
+	const char* Config::HamsterEnableTransactions							= "Ht4n.Hamster.EnableTransactions";
+	const char* Config::HamsterTxnMaxCells									= "Ht4n.Hamster.TxnMaxCells";
+	const char* Config::HamsterTxnMaxSizeKB									= "Ht4n.Hamster.TxnMaxSizeKB";
+	const char* Config::HamsterTxnMaxAgeMsec								= "Ht4n.Hamster.TxnMaxAgeMsec";
+	const char* Config::HamsterCompactionIntervalSec						= "Ht4n.Hamster.CompactionIntervalSec";
+	const char* Config::HamsterCompactionMaxCells							= "Ht4n.Hamster.CompactionMaxCells";
 
 #endif
 
@@ -69,10 +79,24 @@ namespace ht4c { namespace Common {
 	const char* Config::SQLiteCacheSizeMB									= "Ht4n.SQLite.CacheSizeMB";
 	const char* Config::SQLitePageSizeKB									= "Ht4n.SQLite.PageSizeKB";
 	const char* Config::SQLiteWriteAheadLog									= "Ht4n.SQLite.WAL";
+	const char* Config::SQLiteReadConnections								= "Ht4n.SQLite.ReadConnections";
+	const char* Config::SQLiteCommitCells									= "Ht4n.SQLite.CommitCells";
+	const char* Config::SQLiteCommitSizeMB									= "Ht4n.SQLite.CommitSizeMB";
+	const char* Config::SQLiteCommitIntervalMsec							= "Ht4n.SQLite.CommitIntervalMsec";
+	const char* Config::SQLiteGroupCommit									= "Ht4n.SQLite.GroupCommit";
+	const char* Config::SQLiteMmapSizeMB									= "Ht4n.SQLite.MmapSizeMB";
+	const char* Config::SQLiteWalAutoCheckpoint								= "Ht4n.SQLite.WalAutoCheckpoint";
+	const char* Config::SQLiteCheckpointIntervalMsec						= "Ht4n.SQLite.CheckpointIntervalMsec";
+	const char* Config::SQLitePurgeIntervalMsec								= "Ht4n.SQLite.PurgeIntervalMsec";
+	const char* Config::SQLitePurgeBatchCells								= "Ht4n.SQLite.PurgeBatchCells";
+	const char* Config::SQLitePurgeVersions									= "Ht4n.SQLite.PurgeVersions";
+	const char* Config::SQLiteCacheSpill									= "Ht4n.SQLite.CacheSpill";
 	const char* Config::SQLiteSynchronous									= "Ht4n.SQLite.Synchronous";
 	const char* Config::SQLiteAutoVacuum									= "Ht4n.SQLite.AutoVacuum";
 	const char* Config::SQLiteUniqueRows									= "Ht4n.SQLite.UniqueRows";
 	const char* Config::SQLiteNoCellRevisions								= "Ht4n.SQLite.NoCellRevisions";
+	const char* Config::SQLiteWithoutRowId									= "Ht4n.SQLite.WithoutRowId";
+	const char* Config::SQLiteShardPerTable									= "Ht4n.SQLite.ShardPerTable";
 	const char* Config::SQLiteIndexColumn									= "Ht4n.SQLite.Index.Column";
 	const char* Config::SQLiteIndexColumnFamily								= "Ht4n.SQLite.Index.ColumnFamily";
 	const char* Config::SQLiteIndexColumnQualifier							= "Ht4n.SQLite.Index.ColumnQualifier";
@@ -88,6 +112,14 @@ namespace ht4c { namespace Common {
 	const char* Config::OdbcIndexColumnFamily								= "Ht4n.Odbc.Index.ColumnFamily";
 	const char* Config::OdbcIndexColumnQualifier							= "Ht4n.Odbc.Index.ColumnQualifier";
 	const char* Config::OdbcIndexTimestamp									= "Ht4n.Odbc.Index.Timestamp";
+	const char* Config::OdbcBulkInsertRows									= "Ht4n.Odbc.BulkInsertRows";
+	const char* Config::OdbcMaxConnections									= "Ht4n.Odbc.MaxConnections";
+	const char* Config::OdbcLockTimeoutMsec									= "Ht4n.Odbc.LockTimeoutMsec";
+	const char* Config::OdbcPurgeIntervalMsec								= "Ht4n.Odbc.PurgeIntervalMsec";
+	const char* Config::OdbcPurgeBatchCells									= "Ht4n.Odbc.PurgeBatchCells";
+	const char* Config::OdbcFetchSizeKB										= "Ht4n.Odbc.FetchSizeKB";
+	const char* Config::OdbcTableLayout										= "Ht4n.Odbc.TableLayout";
+	const char* Config::OdbcTableCompression								= "Ht4n.Odbc.TableCompression";
 
 #endif
 
@@ -136,6 +136,56 @@ namespace ht4c { namespace Common {
 			/// </summary>
 			static const char* HamsterPageSizeKB;
 
+			/// <summary>
+			/// Hamster db scan resistant cache, pages used only once are evicted first.
+			/// </summary>
+			static const char* HamsterCacheScanResistant;
+
+			/// <summary>
+			/// Hamster db max number of dirty pages in the cache, 0 for unlimited.
+			/// </summary>
+			static const char* HamsterCacheDirtyPageLimit;
+
+			/// <summary>
+			/// Hamster db binary (memcmp comparable) keys for new tables.
+			/// </summary>
+			static const char* HamsterBinaryKeys;
+
+			/// <summary>
+			/// Hamster db migrate existing tables to binary keys.
+			/// </summary>
+			static const char* HamsterMigrateKeys;
+
+			/// <summary>
+			/// Hamster db enable transactions, mutators batch cells into transactions.
+			/// </summary>
+			static const char* HamsterEnableTransactions;
+
+			/// <summary>
+			/// Hamster db max number of cells per mutator transaction.
+			/// </summary>
+			static const char* HamsterTxnMaxCells;
+
+			/// <summary>
+			/// Hamster db max size of a mutator transaction [KB].
+			/// </summary>
+			static const char* HamsterTxnMaxSizeKB;
+
+			/// <summary>
+			/// Hamster db max age of a mutator transaction [ms], scanners do not see the cells of an open transaction.
+			/// </summary>
+			static const char* HamsterTxnMaxAgeMsec;
+
+			/// <summary>
+			/// Hamster db interval between two background compaction steps [s], 0 disables the compaction.
+			/// </summary>
+			static const char* HamsterCompactionIntervalSec;
+
+			/// <summary>
+			/// Hamster db max number of cells examined per background compaction step.
+			/// </summary>
+			static const char* HamsterCompactionMaxCells;
+
 #endif
 
 #ifdef SUPPORT_SQLITEDB
@@ -160,6 +210,66 @@ namespace ht4c { namespace Common {
 			/// </summary>
 			static const char* SQLiteWriteAheadLog;
 
+			/// <summary>
+			/// SQLite max number of pooled read-only connections, requires wal.
+			/// </summary>
+			static const char* SQLiteReadConnections;
+
+			/// <summary>
+			/// SQLite max number of cells per mutator transaction, 0 for no limit.
+			/// </summary>
+			static const char* SQLiteCommitCells;
+
+			/// <summary>
+			/// SQLite max size of a mutator transaction [MB], 0 for no limit.
+			/// </summary>
+			static const char* SQLiteCommitSizeMB;
+
+			/// <summary>
+			/// SQLite max age of a mutator transaction [ms], 0 for no limit.
+			/// </summary>
+			static const char* SQLiteCommitIntervalMsec;
+
+			/// <summary>
+			/// SQLite group commit across mutators, requires a non-zero commit interval.
+			/// </summary>
+			static const char* SQLiteGroupCommit;
+
+			/// <summary>
+			/// SQLite memory-mapped I/O size [MB], 0 to disable.
+			/// </summary>
+			static const char* SQLiteMmapSizeMB;
+
+			/// <summary>
+			/// SQLite wal auto-checkpoint [pages], 0 to disable.
+			/// </summary>
+			static const char* SQLiteWalAutoCheckpoint;
+
+			/// <summary>
+			/// SQLite passive checkpoint interval [ms], 0 to disable.
+			/// </summary>
+			static const char* SQLiteCheckpointIntervalMsec;
+
+			/// <summary>
+			/// SQLite background ttl and max versions purge interval [ms], 0 to disable.
+			/// </summary>
+			static const char* SQLitePurgeIntervalMsec;
+
+			/// <summary>
+			/// SQLite background purge of cell versions exceeding max versions, ranks each column family per batch.
+			/// </summary>
+			static const char* SQLitePurgeVersions;
+
+			/// <summary>
+			/// SQLite max number of cells deleted per purge transaction.
+			/// </summary>
+			static const char* SQLitePurgeBatchCells;
+
+			/// <summary>
+			/// SQLite cache spill.
+			/// </summary>
+			static const char* SQLiteCacheSpill;
+
 			/// <summary>
 			/// SQLite synchronous.
 			/// </summary>
@@ -183,6 +293,16 @@ namespace ht4c { namespace Common {
 			/// </summary>
 			static const char* SQLiteNoCellRevisions;  
 
+			/// <summary>
+			/// SQLite creates new tables as WITHOUT ROWID tables, clustered by the cell key.
+			/// </summary>
+			static const char* SQLiteWithoutRowId;
+
+			/// <summary>
+			/// SQLite stores each new table in a separate database file.
+			/// </summary>
+			static const char* SQLiteShardPerTable;
+
 			/// <summary>
 			/// SQLite column index.
 			/// </summary>
@@ -232,6 +352,46 @@ namespace ht4c { namespace Common {
 			/// </summary>
 			static const char* OdbcIndexTimestamp;
 
+			/// <summary>
+			/// Odbc bulk insert array size, mutators stage the cells and merge them set-based.
+			/// </summary>
+			static const char* OdbcBulkInsertRows;
+
+			/// <summary>
+			/// Odbc max number of idle connections kept, scanners and mutators open further connections as needed.
+			/// </summary>
+			static const char* OdbcMaxConnections;
+
+			/// <summary>
+			/// Odbc max wait of a scanner for a row locked by an unflushed mutator.
+			/// </summary>
+			static const char* OdbcLockTimeoutMsec;
+
+			/// <summary>
+			/// Odbc interval of the background purge of expired cells, tables with a ttl get a (cf, ts) index.
+			/// </summary>
+			static const char* OdbcPurgeIntervalMsec;
+
+			/// <summary>
+			/// Odbc max number of cells deleted per purge transaction.
+			/// </summary>
+			static const char* OdbcPurgeBatchCells;
+
+			/// <summary>
+			/// Odbc scanner fetch buffer size, the number of rows fetched per round trip depends on the row size.
+			/// </summary>
+			static const char* OdbcFetchSizeKB;
+
+			/// <summary>
+			/// Odbc table layout, heap, clustered key or clustered columnstore.
+			/// </summary>
+			static const char* OdbcTableLayout;
+
+			/// <summary>
+			/// Odbc table data compression, applies to the heap and clustered key layouts.
+			/// </summary>
+			static const char* OdbcTableCompression;
+
 
 #endif
 
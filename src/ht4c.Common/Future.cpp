@@ -0,0 +1,375 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+#include "stdafx.h"
+#include "Future.h"
+#include "Exception.h"
+
+namespace ht4c { namespace Common {
+
+	Future::Future( size_t _capacity )
+	: capacity( _capacity )
+	, queued( 0 )
+	, working( 0 )
+	, cancelled( false )
+	{
+	}
+
+	Future::~Future( ) {
+		results.clear();
+	}
+
+	bool Future::enqueue( const Result& result ) {
+		std::unique_lock<std::mutex> lock( mutex );
+
+		// Back-pressure, block the producer until the consumer has made room,
+		// a single result exceeding the capacity passes if the queue is empty
+		while(    capacity && queued && queued + result.size > capacity
+					 && cancelledIds.find(result.id) == cancelledIds.end() ) {
+
+			cond.wait( lock );
+		}
+		if( cancelledIds.find(result.id) != cancelledIds.end() ) {
+			return false;
+		}
+		results.push_back( result );
+		queued += result.size;
+		cond.notify_all();
+		return true;
+	}
+
+	bool Future::dequeue( Result& result, uint32_t timeoutMsec ) {
+		std::unique_lock<std::mutex> lock( mutex );
+		std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeoutMsec );
+		while( results.empty() ) {
+			if( cond.wait_until(lock, timeout) == std::cv_status::timeout && results.empty() ) {
+				return false;
+			}
+		}
+		result = results.front();
+		results.pop_front();
+		queued -= result.size;
+		cond.notify_all();
+		return true;
+	}
+
+	bool Future::isEmpty( ) const {
+		std::lock_guard<std::mutex> lock( mutex );
+		return results.empty();
+	}
+
+	bool Future::hasOutstanding( ) const {
+		std::lock_guard<std::mutex> lock( mutex );
+		return working > 0 || !results.empty();
+	}
+
+	void Future::attach( int64_t id ) {
+		// a scanner or mutator attached after a cancel starts a new round
+		std::lock_guard<std::mutex> lock( mutex );
+		attachedIds.insert( id );
+		cancelled = false;
+	}
+
+	void Future::detach( int64_t id ) {
+		// ids are addresses, forget them before they can be reused
+		std::lock_guard<std::mutex> lock( mutex );
+		attachedIds.erase( id );
+		cancelledIds.erase( id );
+	}
+
+	void Future::cancel( ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		cancelled = true;
+		cancelledIds.insert( attachedIds.begin(), attachedIds.end() );
+		results.clear();
+		queued = 0;
+		cond.notify_all();
+	}
+
+	bool Future::isCancelled( ) const {
+		std::lock_guard<std::mutex> lock( mutex );
+		return cancelled;
+	}
+
+	void Future::cancel( int64_t id ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		if( attachedIds.find(id) != attachedIds.end() ) {
+			cancelledIds.insert( id );
+		}
+		for( std::deque<Result>::iterator it = results.begin(); it != results.end(); ) {
+			if( (*it).id == id ) {
+				queued -= (*it).size;
+				it = results.erase( it );
+			}
+			else {
+				++it;
+			}
+		}
+		cond.notify_all();
+	}
+
+	bool Future::isCancelled( int64_t id ) const {
+		std::lock_guard<std::mutex> lock( mutex );
+		return cancelledIds.find( id ) != cancelledIds.end();
+	}
+
+	void Future::beginWork( ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		++working;
+	}
+
+	void Future::endWork( ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		--working;
+		cond.notify_all();
+	}
+
+	void Future::join( ) {
+		std::unique_lock<std::mutex> lock( mutex );
+		while( working > 0 ) {
+			cond.wait( lock );
+		}
+	}
+
+	MutatorAsync::MutatorAsync( FuturePtr _future )
+	: future( _future )
+	, running( false )
+	, cancelled( false )
+	{
+		future->attach( getId() );
+	}
+
+	MutatorAsync::~MutatorAsync( ) {
+		future->detach( getId() );
+		future = 0;
+	}
+
+	void MutatorAsync::set( const Hypertable::Cells& cells ) {
+		if( cells.empty() ) {
+			return;
+		}
+
+		// The caller owns the cell buffers, copy them for the worker
+		Hypertable::CellsBuilderPtr cellsBuilder = std::make_shared<Hypertable::CellsBuilder>( cells.size() );
+		for each( const Hypertable::Cell& cell in cells ) {
+			cellsBuilder->add( cell, true );
+		}
+
+		std::lock_guard<std::mutex> lock( mutex );
+		if( cancelled || future->isCancelled(getId()) ) {
+			return;
+		}
+		pending.push_back( cellsBuilder );
+		if( !running ) {
+			MutatorAsyncPtr* param = new MutatorAsyncPtr( this );
+			future->beginWork();
+			if( !::QueueUserWorkItem(workerProc, param, WT_EXECUTELONGFUNCTION) ) {
+				DWORD err = ::GetLastError();
+				future->endWork();
+				pending.pop_back();
+				delete param;
+				throw HypertableException( Hypertable::Error::EXTERNAL, winapi_strerror(err), __LINE__, __FUNCTION__, __FILE__ );
+			}
+			running = true;
+		}
+	}
+
+	void MutatorAsync::flush( ) {
+		wait();
+		if( !cancelled ) {
+			flushWritten();
+		}
+	}
+
+	void MutatorAsync::cancel( ) {
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			cancelled = true;
+			pending.clear();
+		}
+		wait();
+	}
+
+	void MutatorAsync::wait( ) {
+		std::unique_lock<std::mutex> lock( mutex );
+		while( running ) {
+			cond.wait( lock );
+		}
+	}
+
+	void MutatorAsync::run( ) {
+		while( true ) {
+			Hypertable::CellsBuilderPtr cellsBuilder;
+			{
+				std::lock_guard<std::mutex> lock( mutex );
+				if( cancelled || future->isCancelled(getId()) ) {
+					pending.clear();
+					running = false;
+					cond.notify_all();
+					return;
+				}
+				if( !pending.empty() ) {
+					cellsBuilder = pending.front();
+					pending.pop_front();
+				}
+			}
+
+			try {
+				HT4C_TRY {
+					if( cellsBuilder ) {
+						write( cellsBuilder->get() );
+					}
+					else {
+						idle();
+					}
+				}
+				HT4C_RETHROW
+
+				if( !cellsBuilder ) {
+					std::lock_guard<std::mutex> lock( mutex );
+					if( pending.empty() ) {
+						running = false;
+						cond.notify_all();
+						return;
+					}
+				}
+			}
+			catch( HypertableException& e ) {
+				Future::Result result;
+				result.id = getId();
+				result.isError = true;
+				result.error = e.code();
+				result.errorMsg = e.what();
+				future->enqueue( result );
+
+				std::lock_guard<std::mutex> lock( mutex );
+				cancelled = true;
+			}
+		}
+	}
+
+	DWORD MutatorAsync::workerProc( void* param ) {
+		MutatorAsyncPtr* mutator = reinterpret_cast<MutatorAsyncPtr*>( param );
+		FuturePtr future = (*mutator)->future;
+		(*mutator)->run();
+		delete mutator;
+		future->endWork();
+		return 0;
+	}
+
+	ScannerAsync::ScannerAsync( FuturePtr _future )
+	: future( _future )
+	, running( false )
+	{
+		future->attach( getId() );
+	}
+
+	ScannerAsync::~ScannerAsync( ) {
+		future->detach( getId() );
+		future = 0;
+	}
+
+	void ScannerAsync::start( ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		if( !running ) {
+			ScannerAsyncPtr* param = new ScannerAsyncPtr( this );
+			future->beginWork();
+			if( !::QueueUserWorkItem(workerProc, param, WT_EXECUTELONGFUNCTION) ) {
+				DWORD err = ::GetLastError();
+				future->endWork();
+				delete param;
+				throw HypertableException( Hypertable::Error::EXTERNAL, winapi_strerror(err), __LINE__, __FUNCTION__, __FILE__ );
+			}
+			running = true;
+		}
+	}
+
+	void ScannerAsync::cancel( ) {
+		future->cancel( getId() );
+	}
+
+	void ScannerAsync::wait( ) {
+		std::unique_lock<std::mutex> lock( mutex );
+		while( running ) {
+			cond.wait( lock );
+		}
+	}
+
+	void ScannerAsync::run( ) {
+		Future::Result result;
+		result.id = getId();
+		result.isScan = true;
+
+		try {
+			HT4C_TRY {
+				bool eos = false;
+				while( !eos ) {
+					if( future->isCancelled(result.id) ) {
+						return;
+					}
+
+					result.cells = std::make_shared<Hypertable::CellsBuilder>( BATCH_CELLS );
+					uint32_t size;
+					eos = !read( *result.cells, BATCH_CELLS, BATCH_BYTES, size );
+					result.size = size;
+
+					if( !result.cells->get().empty() && !future->enqueue(result) ) {
+						return;
+					}
+				}
+
+				result.cells = Hypertable::CellsBuilderPtr();
+				result.size = 0;
+				result.isEmpty = true;
+				future->enqueue( result );
+			}
+			HT4C_RETHROW
+		}
+		catch( HypertableException& e ) {
+			Future::Result error;
+			error.id = result.id;
+			error.isScan = true;
+			error.isError = true;
+			error.error = e.code();
+			error.errorMsg = e.what();
+			future->enqueue( error );
+		}
+	}
+
+	DWORD ScannerAsync::workerProc( void* param ) {
+		ScannerAsyncPtr* scanner = reinterpret_cast<ScannerAsyncPtr*>( param );
+		FuturePtr future = (*scanner)->future;
+		(*scanner)->run();
+		{
+			std::lock_guard<std::mutex> lock( (*scanner)->mutex );
+			(*scanner)->running = false;
+			(*scanner)->cond.notify_all();
+		}
+		delete scanner;
+		future->endWork();
+		return 0;
+	}
+
+} }
\ No newline at end of file
@@ -0,0 +1,198 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#pragma once
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <set>
+
+#include "Common/ReferenceCount.h"
+#include "Hypertable/Lib/Cells.h"
+
+namespace ht4c { namespace Common {
+
+	class Future;
+	typedef boost::intrusive_ptr<Future> FuturePtr;
+
+	class MutatorAsync;
+	typedef boost::intrusive_ptr<MutatorAsync> MutatorAsyncPtr;
+
+	class ScannerAsync;
+	typedef boost::intrusive_ptr<ScannerAsync> ScannerAsyncPtr;
+
+	/// <summary>
+	/// Bounded result queue shared by the asynchronous scanners and mutators of an embedded provider.
+	/// </summary>
+	class Future : public Hypertable::ReferenceCount {
+
+		public:
+
+			struct Result {
+				int64_t id;
+				bool isScan;
+				bool isEmpty;
+				bool isError;
+				int error;
+				std::string errorMsg;
+				Hypertable::CellsBuilderPtr cells;
+				size_t size;
+
+				Result( )
+				: id( 0 )
+				, isScan( false )
+				, isEmpty( false )
+				, isError( false )
+				, error( 0 )
+				, size( 0 )
+				{
+				}
+			};
+
+			explicit Future( size_t capacity );
+			virtual ~Future( );
+
+			bool enqueue( const Result& result );
+			bool dequeue( Result& result, uint32_t timeoutMsec );
+			bool isEmpty( ) const;
+			bool hasOutstanding( ) const;
+			void attach( int64_t id );
+			void detach( int64_t id );
+			void cancel( );
+			bool isCancelled( ) const;
+			void cancel( int64_t id );
+			bool isCancelled( int64_t id ) const;
+			void beginWork( );
+			void endWork( );
+			void join( );
+
+		private:
+
+			size_t capacity;
+			size_t queued;
+			int working;
+			bool cancelled;
+			std::deque<Result> results;
+			std::set<int64_t> attachedIds;
+			std::set<int64_t> cancelledIds;
+			mutable std::mutex mutex;
+			std::condition_variable cond;
+	};
+
+	/// <summary>
+	/// Applies the cells of an asynchronous mutator in order on a single worker.
+	/// </summary>
+	class MutatorAsync : public Hypertable::ReferenceCount {
+
+		public:
+
+			virtual ~MutatorAsync( );
+
+			inline int64_t getId( ) const {
+				return int64_t(this);
+			}
+			void set( const Hypertable::Cells& cells );
+			void flush( );
+			void cancel( );
+
+		protected:
+
+			explicit MutatorAsync( FuturePtr future );
+
+			/// <summary>
+			/// Writes the cells, called on the worker.
+			/// </summary>
+			virtual void write( const Hypertable::Cells& cells ) = 0;
+
+			/// <summary>
+			/// Flushes the provider mutator, called once the worker has finished.
+			/// </summary>
+			virtual void flushWritten( ) = 0;
+
+			/// <summary>
+			/// Called on the worker once the pending cells have been written.
+			/// </summary>
+			virtual void idle( ) { }
+
+		private:
+
+			void run( );
+			void wait( );
+
+			static DWORD WINAPI workerProc( void* param );
+
+			FuturePtr future;
+			std::deque<Hypertable::CellsBuilderPtr> pending;
+			bool running;
+			bool cancelled;
+			std::mutex mutex;
+			std::condition_variable cond;
+	};
+
+	/// <summary>
+	/// Streams the batches of an asynchronous scanner from a worker into the future.
+	/// </summary>
+	class ScannerAsync : public Hypertable::ReferenceCount {
+
+		public:
+
+			virtual ~ScannerAsync( );
+
+			inline int64_t getId( ) const {
+				return int64_t(this);
+			}
+			void start( );
+			void cancel( );
+			void wait( );
+
+		protected:
+
+			explicit ScannerAsync( FuturePtr future );
+
+			/// <summary>
+			/// Reads the next batch, called on the worker.
+			/// </summary>
+			/// <returns>false if the scan has been completed</returns>
+			virtual bool read( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size ) = 0;
+
+		private:
+
+			enum {
+				BATCH_CELLS = 1024
+			, BATCH_BYTES = 256 * 1024
+			};
+
+			void run( );
+
+			static DWORD WINAPI workerProc( void* param );
+
+			FuturePtr future;
+			bool running;
+			std::mutex mutex;
+			std::condition_variable cond;
+	};
+
+} }
\ No newline at end of file
@@ -34,6 +34,7 @@ namespace ht4c { namespace Common {
 		MF_Default         = 0x00
 	, MF_NoLogSync       = 0x01 // Don't force a commit log sync on update
 	, MF_IgnoreUnknownCf = 0x02
+	, MF_SortedInput     = 0x10 // Cells are set in ascending key order (bulk load), embedded providers only
 	};
 
 } }
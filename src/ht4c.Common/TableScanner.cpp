@@ -0,0 +1,49 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+#include "stdafx.h"
+#include "TableScanner.h"
+#include "Cells.h"
+
+namespace ht4c { namespace Common {
+
+	bool TableScanner::nextCells( Cells& cells, uint32_t maxCells, uint32_t maxBytes ) {
+		uint32_t count = 0;
+		uint32_t size = 0;
+		Cell* cell;
+		while( count < maxCells && size < maxBytes ) {
+			if( !next(cell) ) {
+				return count > 0;
+			}
+			cells.add( cell->get() );
+			++count;
+			size += static_cast<uint32_t>( cell->get().row_key ? strlen(cell->get().row_key) : 0 )
+					  + static_cast<uint32_t>( cell->get().column_qualifier ? strlen(cell->get().column_qualifier) : 0 )
+					  + cell->get().value_len;
+		}
+		return true;
+	}
+
+} }
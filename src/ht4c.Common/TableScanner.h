@@ -25,9 +25,12 @@
 #pragma managed( push, off )
 #endif
 
+#include "Types.h"
+
 namespace ht4c { namespace Common {
 
 	class Cell;
+	class Cells;
 	class HypertableException;
 
 	/// <summary>
@@ -49,6 +52,16 @@ namespace ht4c { namespace Common {
 			/// <returns>true if succeeded, false if the scan has been completed</returns>
 			virtual bool next( Cell*& cell ) = 0;
 
+			/// <summary>
+			/// Appends the next batch of cells to the specified cell collection.
+			/// </summary>
+			/// <param name="cells">Receives the cells</param>
+			/// <param name="maxCells">Maximum number of cells to append</param>
+			/// <param name="maxBytes">Maximum number of bytes to append, approximately</param>
+			/// <returns>true if any cell has been appended, false if the scan has been completed</returns>
+			/// <remarks>The default implementation calls next for each cell.</remarks>
+			virtual bool nextCells( Cells& cells, uint32_t maxCells, uint32_t maxBytes );
+
 		protected:
 
 			/// <summary>
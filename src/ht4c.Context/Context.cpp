@@ -267,7 +267,17 @@ namespace ht4c {
 					(Common::Config::HamsterEnableRecovery, boo()->default_value(false), "Enable or disable hamster db recovery (default: false)\n")
 					(Common::Config::HamsterEnableAutoRecovery, boo()->default_value(false), "Enable or disable hamster db auto-recovery (default: false)\n")
 					(Common::Config::HamsterCacheSizeMB, i32()->default_value(64), "Hamster db cache size [MB] (default:64)\n")
-					(Common::Config::HamsterPageSizeKB, i32()->default_value(64), "Hamster db page size [KB] (default:64)\n");
+					(Common::Config::HamsterPageSizeKB, i32()->default_value(64), "Hamster db page size [KB] (default:64)\n")
+					(Common::Config::HamsterCacheScanResistant, boo()->default_value(false), "Enable or disable the scan resistant hamster db cache, pages used only once are evicted first (default: false)\n")
+					(Common::Config::HamsterCacheDirtyPageLimit, i32()->default_value(0), "Hamster db max number of dirty pages in the cache, 0 for unlimited (default:0)\n")
+					(Common::Config::HamsterBinaryKeys, boo()->default_value(false), "Create new hamster db tables with binary keys (default:false)\n")
+					(Common::Config::HamsterMigrateKeys, boo()->default_value(false), "Migrate existing hamster db tables to binary keys (default:false)\n")
+					(Common::Config::HamsterEnableTransactions, boo()->default_value(false), "Enable or disable hamster db transactions, mutators apply cells in batches (default: false)\n")
+					(Common::Config::HamsterTxnMaxCells, i32()->default_value(10000), "Hamster db max number of cells per mutator transaction (default:10000)\n")
+					(Common::Config::HamsterTxnMaxSizeKB, i32()->default_value(4096), "Hamster db max size of a mutator transaction [KB] (default:4096)\n")
+					(Common::Config::HamsterTxnMaxAgeMsec, i32()->default_value(1000), "Hamster db max age of a mutator transaction [ms], cells are not visible to scanners before commit (default:1000)\n")
+					(Common::Config::HamsterCompactionIntervalSec, i32()->default_value(0), "Hamster db interval between two background compaction steps [s], 0 disables the compaction (default:0)\n")
+					(Common::Config::HamsterCompactionMaxCells, i32()->default_value(10000), "Hamster db max number of cells examined per background compaction step (default:10000)\n");
 
 #endif
 
@@ -278,10 +288,24 @@ namespace ht4c {
 					(Common::Config::SQLiteCacheSizeMB, i32()->default_value(64), "SQLite db cache size [MB] (default:64)\n")
 					(Common::Config::SQLitePageSizeKB, i32()->default_value(4), "SQLite db page size [KB] (default:4)\n")
 					(Common::Config::SQLiteWriteAheadLog, boo()->default_value(false), "SQLite WAL (default:false)\n")
+					(Common::Config::SQLiteReadConnections, i32()->default_value(4), "SQLite max number of pooled read-only connections for scanners, requires WAL (default:4)\n")
+					(Common::Config::SQLiteCommitCells, i32()->default_value(100000), "SQLite max number of cells per mutator transaction, 0 for no limit (default:100000)\n")
+					(Common::Config::SQLiteCommitSizeMB, i32()->default_value(64), "SQLite max size of a mutator transaction [MB], 0 for no limit (default:64)\n")
+					(Common::Config::SQLiteCommitIntervalMsec, i32()->default_value(1000), "SQLite max age of a mutator transaction [ms], 0 for no limit (default:1000)\n")
+					(Common::Config::SQLiteGroupCommit, boo()->default_value(false), "SQLite group commit across mutators, requires a non-zero commit interval (default:false)\n")
+					(Common::Config::SQLiteMmapSizeMB, i32()->default_value(0), "SQLite memory-mapped I/O size [MB], 0 to disable (default:0)\n")
+					(Common::Config::SQLiteWalAutoCheckpoint, i32()->default_value(1000), "SQLite WAL auto-checkpoint [pages], 0 to disable (default:1000)\n")
+					(Common::Config::SQLiteCheckpointIntervalMsec, i32()->default_value(0), "SQLite passive checkpoint interval [ms], requires WAL, 0 to disable (default:0)\n")
+					(Common::Config::SQLitePurgeIntervalMsec, i32()->default_value(60000), "SQLite background purge interval of expired cells and exceeding cell versions [ms], creates a (cf, ts) index on tables with a ttl, 0 to disable (default:60000)\n")
+					(Common::Config::SQLitePurgeVersions, boo()->default_value(false), "SQLite background purge of cell versions exceeding max versions, ranks the cells of the column family per purge transaction (default:false)\n")
+					(Common::Config::SQLitePurgeBatchCells, i32()->default_value(1000), "SQLite max number of cells deleted per purge transaction (default:1000)\n")
+					(Common::Config::SQLiteCacheSpill, boo()->default_value(true), "SQLite cache spill (default:true)\n")
 					(Common::Config::SQLiteSynchronous, boo()->default_value(false), "SQLite synchronous (default:false)\n")
 					(Common::Config::SQLiteAutoVacuum, i32()->default_value(0), "SQLite auto-vacuum (default:0)\n")
 					(Common::Config::SQLiteUniqueRows, boo()->default_value(false), "SQLite unique rows (default:false)\n")
 					(Common::Config::SQLiteNoCellRevisions, boo()->default_value(false), "SQLite no cell revisions (default:false)\n")
+					(Common::Config::SQLiteWithoutRowId, boo()->default_value(false), "SQLite create new tables WITHOUT ROWID, clustered by the cell key (default:false)\n")
+					(Common::Config::SQLiteShardPerTable, boo()->default_value(false), "SQLite store each new table in a separate database file <filename>.t<id> (default:false)\n")
 					(Common::Config::SQLiteIndexColumn, boo()->default_value(false), "Enables SQLite column index (default:false)\n")
 					(Common::Config::SQLiteIndexColumnFamily, boo()->default_value(false), "Enables SQLite column family index (default:false)\n")
 					(Common::Config::SQLiteIndexColumnQualifier, boo()->default_value(false), "Enables SQLite column qualifier index (default:false)\n")
@@ -296,7 +320,15 @@ namespace ht4c {
 					(Common::Config::OdbcIndexColumn, boo()->default_value(false), "Enables ODBC column index (default:false)\n")
 					(Common::Config::OdbcIndexColumnFamily, boo()->default_value(false), "Enables ODBC column family index (default:false)\n")
 					(Common::Config::OdbcIndexColumnQualifier, boo()->default_value(false), "Enables ODBC column qualifier index (default:false)\n")
-					(Common::Config::OdbcIndexTimestamp, boo()->default_value(false), "Enables ODBC timestamp index (default:false)\n");
+					(Common::Config::OdbcIndexTimestamp, boo()->default_value(false), "Enables ODBC timestamp index (default:false)\n")
+					(Common::Config::OdbcBulkInsertRows, i32()->default_value(0), "ODBC bulk insert array size, stages the cells and merges them set-based, 0 disables bulk inserts (default:0)\n")
+					(Common::Config::OdbcMaxConnections, i32()->default_value(8), "ODBC max number of idle connections kept for scanners and mutators, further connections are opened as needed (default:8)\n")
+					(Common::Config::OdbcLockTimeoutMsec, i32()->default_value(30000), "ODBC max wait [ms] of a scanner for a row locked by an unflushed mutator, scanners read row versions if the database allows snapshot isolation (default:30000)\n")
+					(Common::Config::OdbcPurgeIntervalMsec, i32()->default_value(60000), "ODBC interval [ms] of the background purge of expired cells, creates a (cf, ts) index on tables with a ttl, 0 disables the purge (default:60000)\n")
+					(Common::Config::OdbcPurgeBatchCells, i32()->default_value(1000), "ODBC max number of cells deleted per purge transaction (default:1000)\n")
+					(Common::Config::OdbcFetchSizeKB, i32()->default_value(1024), "ODBC scanner fetch buffer size [KB] (default:1024)\n")
+					(Common::Config::OdbcTableLayout, str()->default_value("heap"), "ODBC table layout [heap|clustered|columnstore] (default:heap)\n")
+					(Common::Config::OdbcTableCompression, str()->default_value("none"), "ODBC table data compression [none|row|page] (default:none)\n");
 
 #endif
 
@@ -677,10 +709,27 @@ namespace ht4c {
 
 	bool Context::hasFeature( Common::ContextFeature contextFeature ) const {
 		switch( contextFeature ) {
-		case Common::CF_HQL:
 		case Common::CF_AsyncTableMutator:
-		case Common::CF_PeriodicFlushTableMutator:
 		case Common::CF_AsyncTableScanner:
+
+#ifdef SUPPORT_HAMSTERDB
+
+			if( contextKind == Common::CK_Hamster ) {
+				return true;
+			}
+
+#endif
+
+#ifdef SUPPORT_SQLITEDB
+
+			if( contextKind == Common::CK_SQLite ) {
+				return true;
+			}
+
+#endif
+
+		case Common::CF_HQL:
+		case Common::CF_PeriodicFlushTableMutator:
 		case Common::CF_CounterColumn:
 
 #ifdef SUPPORT_HYPERTABLE
@@ -920,6 +969,16 @@ namespace ht4c {
 				config.enableAutoRecovery = properties->get_bool( Common::Config::HamsterEnableAutoRecovery );
 				config.cacheSizeMB = properties->get_i32( Common::Config::HamsterCacheSizeMB );
 				config.pageSizeKB = properties->get_i32( Common::Config::HamsterPageSizeKB );
+				config.cacheScanResistant = properties->get_bool( Common::Config::HamsterCacheScanResistant );
+				config.cacheDirtyPageLimit = properties->get_i32( Common::Config::HamsterCacheDirtyPageLimit );
+				config.binaryKeys = properties->get_bool( Common::Config::HamsterBinaryKeys );
+				config.migrateKeys = properties->get_bool( Common::Config::HamsterMigrateKeys );
+				config.enableTransactions = properties->get_bool( Common::Config::HamsterEnableTransactions );
+				config.txnMaxCells = properties->get_i32( Common::Config::HamsterTxnMaxCells );
+				config.txnMaxSizeKB = properties->get_i32( Common::Config::HamsterTxnMaxSizeKB );
+				config.txnMaxAgeMsec = properties->get_i32( Common::Config::HamsterTxnMaxAgeMsec );
+				config.compactionIntervalSec = properties->get_i32( Common::Config::HamsterCompactionIntervalSec );
+				config.compactionMaxCells = properties->get_i32( Common::Config::HamsterCompactionMaxCells );
 
 				HT_INFO_OUT << "Creating hamster environment " << filename << HT_END;
 				hamsterEnv = Hamster::HamsterFactory::create( filename, config );
@@ -947,10 +1006,24 @@ namespace ht4c {
 				config.cacheSizeMB = properties->get_i32( Common::Config::SQLiteCacheSizeMB );
 				config.pageSizeKB = properties->get_i32( Common::Config::SQLitePageSizeKB );
 				config.writeAheadLog = properties->get_bool( Common::Config::SQLiteWriteAheadLog );
+				config.readConnections = properties->get_i32( Common::Config::SQLiteReadConnections );
+				config.commitCells = properties->get_i32( Common::Config::SQLiteCommitCells );
+				config.commitSizeMB = properties->get_i32( Common::Config::SQLiteCommitSizeMB );
+				config.commitIntervalMsec = properties->get_i32( Common::Config::SQLiteCommitIntervalMsec );
+				config.groupCommit = properties->get_bool( Common::Config::SQLiteGroupCommit );
+				config.mmapSizeMB = properties->get_i32( Common::Config::SQLiteMmapSizeMB );
+				config.walAutoCheckpoint = properties->get_i32( Common::Config::SQLiteWalAutoCheckpoint );
+				config.checkpointIntervalMsec = properties->get_i32( Common::Config::SQLiteCheckpointIntervalMsec );
+				config.purgeIntervalMsec = properties->get_i32( Common::Config::SQLitePurgeIntervalMsec );
+				config.purgeBatchCells = properties->get_i32( Common::Config::SQLitePurgeBatchCells );
+				config.purgeVersions = properties->get_bool( Common::Config::SQLitePurgeVersions );
+				config.cacheSpill = properties->get_bool( Common::Config::SQLiteCacheSpill );
 				config.synchronous = properties->get_bool( Common::Config::SQLiteSynchronous );
 				config.autoVacuum = properties->get_i32( Common::Config::SQLiteAutoVacuum );
 				config.uniqueRows = properties->get_bool( Common::Config::SQLiteUniqueRows );
 				config.noCellRevisions = properties->get_bool( Common::Config::SQLiteNoCellRevisions );
+				config.withoutRowId = properties->get_bool( Common::Config::SQLiteWithoutRowId );
+				config.shardPerTable = properties->get_bool( Common::Config::SQLiteShardPerTable );
 				config.indexColumn = properties->get_bool( Common::Config::SQLiteIndexColumn );
 				config.indexColumnFamily = properties->get_bool( Common::Config::SQLiteIndexColumnFamily );
 				config.indexColumnQualifier = properties->get_bool( Common::Config::SQLiteIndexColumnQualifier );
@@ -982,6 +1055,14 @@ Odbc::OdbcEnvPtr Context::getOdbcEnv( ) {
 			config.indexColumnFamily = properties->get_bool( Common::Config::OdbcIndexColumnFamily );
 			config.indexColumnQualifier = properties->get_bool( Common::Config::OdbcIndexColumnQualifier );
 			config.indexTimestamp = properties->get_bool( Common::Config::OdbcIndexTimestamp );
+			config.bulkInsertRows = properties->get_i32( Common::Config::OdbcBulkInsertRows );
+			config.maxConnections = properties->get_i32( Common::Config::OdbcMaxConnections );
+			config.lockTimeoutMsec = properties->get_i32( Common::Config::OdbcLockTimeoutMsec );
+			config.purgeIntervalMsec = properties->get_i32( Common::Config::OdbcPurgeIntervalMsec );
+			config.purgeBatchCells = properties->get_i32( Common::Config::OdbcPurgeBatchCells );
+			config.fetchSizeKB = properties->get_i32( Common::Config::OdbcFetchSizeKB );
+			config.tableLayout = properties->get_str( Common::Config::OdbcTableLayout );
+			config.tableCompression = properties->get_str( Common::Config::OdbcTableCompression );
 
 			HT_INFO_OUT << "Creating odbc environment " << connectionString << HT_END;
 			odbcEnv = Odbc::OdbcFactory::create( connectionString, config );
@@ -38,12 +38,14 @@ namespace ht4c { namespace Hamster {
 	}
 
 	HamsterAsyncResult::HamsterAsyncResult( size_t _capacity )
-	: /*TODO future( 0 )
-	, */capacity( _capacity >= 0 ? _capacity : 0 )
+	: future( 0 )
+	, asyncResultSink( 0 )
+	, capacity( _capacity >= 0 ? _capacity : 0 )
 	, cancelled( false )
 	, outstanding( 0 )
 	, thread( 0 )
 	, abort( false )
+	, polling( false )
 	, mutex( )
 	, cond( )
 	, asyncTableScanners( )
@@ -51,30 +53,31 @@ namespace ht4c { namespace Hamster {
 	}
 
 	HamsterAsyncResult::HamsterAsyncResult( Common::AsyncResultSink* _asyncResultSink, size_t _capacity )
-	: /*TODO future( 0 )
-	, */asyncResultSink( _asyncResultSink )
+	: future( 0 )
+	, asyncResultSink( _asyncResultSink )
 	, capacity( _capacity )
 	, cancelled( false )
 	, outstanding( 0 )
 	, thread( 0 )
 	, abort( false )
+	, polling( false )
 	, mutex( )
 	, cond( )
 	, asyncTableScanners( )
 	{
 	}
 
-	/*Hypertable::HamsterGen::Future HamsterAsyncResult::get( HamsterEnvPtr _env ) {
+	Db::FuturePtr HamsterAsyncResult::get( HamsterEnvPtr _env ) {
 		HT4C_TRY {
+			std::lock_guard<std::mutex> lock( mutex );
 			if( !future ) {
-				env = _env->get_pooled();
-				HamsterEnvLock sync( env.get() );
-				future = env->future_open( capacity );
-				if( future ) {
+				env = _env;
+				future = new Db::Future( capacity );
+				if( asyncResultSink ) {
 					thread = ::CreateThread( 0, 0, threadProc, this, 0, 0 );
 					if( !thread ) {
 						DWORD err = ::GetLastError();
-						HT4C_HAMSTER_RETRY( env->future_close(future) );
+						future = 0;
 						throw ht4c::Common::HypertableException( Hypertable::Error::EXTERNAL, winapi_strerror(err), __LINE__, __FUNCTION__, __FILE__ );
 					}
 				}
@@ -82,29 +85,22 @@ namespace ht4c { namespace Hamster {
 			return future;
 		}
 		HT4C_HAMSTER_RETHROW
-	}*/
+	}
 
-	/*bool HamsterAsyncResult::publishResult( Hypertable::HamsterGen::ResultSerialized& result, Common::AsyncResult* asyncResult, Common::AsyncResultSink* asyncResultSink, bool raiseException ) {
+	bool HamsterAsyncResult::publishResult( Db::Future::Result& result, Common::AsyncResult* asyncResult, Common::AsyncResultSink* asyncResultSink, bool raiseException ) {
 		if( result.id ) {
-			if( result.is_error ) {
+			if( result.isError ) {
 				asyncResult->cancel();
-				Common::HypertableException exception( result.error, result.error_msg );
+				Common::HypertableException exception( result.error, result.errorMsg );
 				asyncResultSink->failure( exception );
 				if( raiseException ) {
 					throw exception;
 				}
 				return false;
 			}
-			else if( result.is_scan ) {
-				if( result.cells.length() ) {
-					Common::Cells cells( 1024 );
-
-					Hypertable::Cell cell;
-					Hypertable::SerializedCellsReader reader( reinterpret_cast<void*>(const_cast<char*>(result.cells.c_str())), (uint32_t)result.cells.length() );
-					while( reader.next() ) {
-						reader.get( cell );
-						cells.add( cell );
-					}
+			else if( result.isScan ) {
+				if( result.cells && result.cells->get().size() ) {
+					Common::Cells cells( &result.cells->get() );
 					switch( asyncResultSink->scannedCells(result.id, cells) ) {
 						case Common::ACR_Cancel:
 								asyncResult->cancelAsyncScanner( result.id );
@@ -120,10 +116,10 @@ namespace ht4c { namespace Hamster {
 			}
 		}
 		return true;
-	}*/
+	}
 
 	HamsterAsyncResult::~HamsterAsyncResult( ) {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			{
 				std::lock_guard<std::mutex> lock( mutex );
 				abort = true;
@@ -134,24 +130,22 @@ namespace ht4c { namespace Hamster {
 				::CloseHandle( thread );
 			}
 			if( future ) {
-				HamsterEnvLock sync( env.get() );
-				HT4C_HAMSTER_RETRY( env->future_close(future) );
+				future->cancel();
+				future->join();
 				future = 0;
-				for each( int64_t asyncScannerId in asyncTableScanners ) {
-					HT4C_HAMSTER_RETRY( env->async_scanner_close(asyncScannerId) );
-				}
 			}
 			env = 0;
 		}
-		HT4C_HAMSTER_RETHROW*/
+		HT4C_HAMSTER_RETHROW
 	}
 
 	void HamsterAsyncResult::attachAsyncScanner( int64_t asyncScannerId ) {
 		if( asyncScannerId ) {
 			std::lock_guard<std::mutex> lock( mutex );
-			asyncTableScanners.insert( asyncScannerId );
+			if( asyncTableScanners.insert(asyncScannerId).second ) {
+				++outstanding;
+			}
 			cancelled = false;
-			++outstanding;
 			cond.notify_all();
 		}
 	}
@@ -160,133 +154,111 @@ namespace ht4c { namespace Hamster {
 		if( asyncMutatorId ) {
 			std::lock_guard<std::mutex> lock( mutex );
 			cancelled = false;
-			++outstanding;
 			cond.notify_all();
 		}
 	}
 
 	void HamsterAsyncResult::join( ) {
 		HT4C_TRY {
-			std::unique_lock<std::mutex> lock( mutex );
-			// wake up the polling thread, required if async mutators have been attached
-			++outstanding;
-			cond.notify_all();
-			// wait for completion
-			while( outstanding > 0 ) {
-				cond.wait( lock );
+			if( future ) {
+				// wait for the workers, required if async mutators have been attached
+				future->join();
+
+				// wait until all results have been published
+				std::unique_lock<std::mutex> lock( mutex );
+				while( outstanding > 0 || polling || !future->isEmpty() ) {
+					cond.wait( lock );
+				}
 			}
 		}
 		HT4C_HAMSTER_RETHROW
 	}
 
 	void HamsterAsyncResult::cancel( ) {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			if( future ) {
-				{
-					HamsterEnvLock sync( env.get() );
-					env->future_cancel( future );
-				}
+				future->cancel();
 				std::lock_guard<std::mutex> lock( mutex );
 				cancelled = true;
+				asyncTableScanners.clear();
+				outstanding = 0;
+				cond.notify_all();
 			}
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	void HamsterAsyncResult::cancelAsyncScanner( int64_t asyncScannerId ) { 
-		/*HT4C_TRY {
-			if( asyncScannerId ) {
-				{
-					HamsterEnvLock sync( env.get() );
-					env->async_scanner_cancel( asyncScannerId );
-					env->async_scanner_close( asyncScannerId );
-				}
+		HT4C_TRY {
+			if( asyncScannerId && future ) {
+				future->cancel( asyncScannerId );
 				std::lock_guard<std::mutex> lock( mutex );
-				asyncTableScanners.erase( asyncScannerId );
+				if( asyncTableScanners.erase(asyncScannerId) ) {
+					--outstanding;
+					cond.notify_all();
+				}
 			}
 		}
-		HT4C_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_RETHROW
 	}
 
 	void HamsterAsyncResult::cancelAsyncMutator( int64_t asyncMutatorId ) {
-		/*HT4C_TRY {
-			if( asyncMutatorId ) {
-				HamsterEnvLock sync( env.get() );
-				env->async_mutator_cancel( asyncMutatorId );
+		HT4C_TRY {
+			if( asyncMutatorId && future ) {
+				future->cancel( asyncMutatorId );
 			}
 		}
-		HT4C_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_RETHROW
 	}
 
 	bool HamsterAsyncResult::isCompleted( ) const {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			std::lock_guard<std::mutex> lock( mutex );
-			return future ? outstanding == 0 : true;
+			return future ? outstanding == 0 && !polling && !future->hasOutstanding() : true;
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	bool HamsterAsyncResult::isCancelled( ) const {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			if( future ) {
 				std::lock_guard<std::mutex> lock( mutex );
 				if( cancelled ) {
 					return true;
 				}
-				HamsterEnvLock sync( env.get() );
-				return cancelled = env->future_is_cancelled( future );
+				return cancelled = future->isCancelled();
 			}
 			return false;
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	void HamsterAsyncResult::readAndPublishResult( ) {
-		/*while( future && asyncResultSink ) {
-			try {
-				{
-					std::lock_guard<std::mutex> lock( mutex );
-					while( outstanding == 0 && !abort ) {
-						cond.wait( lock );
-					}
-					if( abort ) {
-						break;
-					}
+		while( future && asyncResultSink ) {
+			{
+				std::lock_guard<std::mutex> lock( mutex );
+				if( abort ) {
+					break;
 				}
-				Hypertable::HamsterGen::ResultSerialized result;
-				HT4C_TRY {
-					try {
-						HamsterEnvLock sync( env.get() );
-						env->future_get_result_serialized( result, future, queryFutureResultTimeoutMs );
-					}
-					catch( Hypertable::HamsterGen::ClientException& e ) {
-						if(  e.code == Hypertable::Error::REQUEST_TIMEOUT
-							|| e.code == Hypertable::Error::NOT_IMPLEMENTED ) { // FIXME, HamsterBroker does not implement get_future_result_serialized for async mutators
-
-							continue;
-						}
-						throw;
-					}
+				polling = true;
+			}
+			try {
+				Db::Future::Result result;
+				bool dequeued = future->dequeue( result, queryFutureResultTimeoutMs );
 
-					// ignore cancelled scanners
-					if( result.id && result.is_scan && !result.is_error && !result.is_empty ) {
-						std::lock_guard<std::mutex> lock( mutex );
-						if( asyncTableScanners.find(result.id) == asyncTableScanners.end() ) {
-							continue;
-						}
+				// ignore cancelled scanners
+				if( dequeued && result.isScan && !result.isError ) {
+					std::lock_guard<std::mutex> lock( mutex );
+					if( asyncTableScanners.find(result.id) == asyncTableScanners.end() ) {
+						dequeued = false;
 					}
 				}
-				HT4C_HAMSTER_RETHROW
 
-				if( !publishResult(result, this, asyncResultSink, false) || result.is_empty ) {
+				if( dequeued && publishResult(result, this, asyncResultSink, false) && result.isEmpty ) {
 					std::lock_guard<std::mutex> lock( mutex );
-					outstanding = std::max( 0, --outstanding );
-					cond.notify_all();
+					if( asyncTableScanners.erase(result.id) ) {
+						--outstanding;
+					}
 				}
 			}
 			catch( Common::HypertableException& e ) {
@@ -300,8 +272,12 @@ namespace ht4c { namespace Hamster {
 				Common::HypertableException e( Hypertable::Error::EXTERNAL, ss.str(), __LINE__, __FUNCTION__, __FILE__ );
 				asyncResultSink->failure( e );
 			}
-		}*/
-		HT4C_THROW_NOTIMPLEMENTED();
+			{
+				std::lock_guard<std::mutex> lock( mutex );
+				polling = false;
+				cond.notify_all();
+			}
+		}
 	}
 
 	DWORD HamsterAsyncResult::threadProc( void* param ) {
@@ -312,4 +288,4 @@ namespace ht4c { namespace Hamster {
 		return 0;
 	}
 
-} }
\ No newline at end of file
+} }
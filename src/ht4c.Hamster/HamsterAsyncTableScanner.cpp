@@ -37,11 +37,13 @@ namespace ht4c { namespace Hamster {
 	}
 
 	int64_t HamsterAsyncTableScanner::id( const Db::ScannerAsyncPtr& tableScanner ) {
-		return int64_t(tableScanner.get());
+		return tableScanner->getId();
 	}
 
 	HamsterAsyncTableScanner::~HamsterAsyncTableScanner( ) throw(ht4c::Common::HypertableException) {
 		HT4C_TRY {
+			tableScanner->cancel();
+			tableScanner->wait();
 			tableScanner = 0;
 		}
 		HT4C_HAMSTER_RETHROW
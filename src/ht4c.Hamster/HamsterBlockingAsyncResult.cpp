@@ -39,39 +39,36 @@ namespace ht4c { namespace Hamster {
 	}
 
 	HamsterBlockingAsyncResult::HamsterBlockingAsyncResult( size_t _capacity )
-	: /*TODO future( 0 )
-	, */capacity( _capacity >= 0 ? _capacity : 0 )
+	: future( 0 )
+	, capacity( _capacity >= 0 ? _capacity : 0 )
 	, cancelled( false )
 	, mutex( )
 	, asyncTableScanners( )
 	{
 	}
 
-	/*Hypertable::HamsterGen::Future HamsterBlockingAsyncResult::get( HamsterEnvPtr _env ) {
+	Db::FuturePtr HamsterBlockingAsyncResult::get( HamsterEnvPtr _env ) {
 		HT4C_TRY {
+			std::lock_guard<std::mutex> lock( mutex );
 			if( !future ) {
-				env = _env->get_pooled();
-				HamsterEnvLock sync( env.get() );
-				future = env->future_open( capacity );
+				env = _env;
+				future = new Db::Future( capacity );
 			}
 			return future;
 		}
 		HT4C_HAMSTER_RETHROW
-	}*/
+	}
 
 	HamsterBlockingAsyncResult::~HamsterBlockingAsyncResult( ) {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			if( future ) {
-				HamsterEnvLock sync( env.get() );
-				HT4C_HAMSTER_RETRY( env->future_close(future) );
+				future->cancel();
+				future->join();
 				future = 0;
-				for each( int64_t asyncScannerId in asyncTableScanners ) {
-					HT4C_HAMSTER_RETRY( env->async_scanner_close(asyncScannerId) );
-				}
 			}
 			env = 0;
 		}
-		HT4C_HAMSTER_RETHROW*/
+		HT4C_HAMSTER_RETHROW
 	}
 
 	void HamsterBlockingAsyncResult::attachAsyncScanner( int64_t asyncScannerId ) {
@@ -99,84 +96,59 @@ namespace ht4c { namespace Hamster {
 	}
 
 	void HamsterBlockingAsyncResult::cancel( ) {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			if( future ) {
-				{
-					HamsterEnvLock sync( env.get() );
-					env->future_cancel( future );
-				}
+				future->cancel();
 				std::lock_guard<std::mutex> lock( mutex );
 				cancelled = true;
 			}
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
-	void HamsterBlockingAsyncResult::cancelAsyncScanner( int64_t asyncScannerId ) { 
-		/*HT4C_TRY {
-			if( asyncScannerId ) {
-				{
-					HamsterEnvLock sync( env.get() );
-					env->async_scanner_cancel( asyncScannerId );
-					env->async_scanner_close( asyncScannerId );
-				}
+	void HamsterBlockingAsyncResult::cancelAsyncScanner( int64_t asyncScannerId ) {
+		HT4C_TRY {
+			if( asyncScannerId && future ) {
+				future->cancel( asyncScannerId );
 				std::lock_guard<std::mutex> lock( mutex );
 				asyncTableScanners.erase( asyncScannerId );
 			}
 		}
-		HT4C_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_RETHROW
 	}
 
 	void HamsterBlockingAsyncResult::cancelAsyncMutator( int64_t asyncMutatorId ) {
-		/*HT4C_TRY {
-			if( asyncMutatorId ) {
-				HamsterEnvLock sync( env.get() );
-				env->async_mutator_cancel( asyncMutatorId );
+		HT4C_TRY {
+			if( asyncMutatorId && future ) {
+				future->cancel( asyncMutatorId );
 			}
 		}
-		HT4C_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_RETHROW
 	}
 
 	bool HamsterBlockingAsyncResult::isCompleted( ) const {
-		/*HT4C_TRY {
-			if( future ) {
-				HamsterEnvLock sync( env.get() );
-				return !env->future_has_outstanding( future );
-			}
-			else {
-				return true;
-			}
+		HT4C_TRY {
+			return future ? !future->hasOutstanding() : true;
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	bool HamsterBlockingAsyncResult::isCancelled( ) const {
-		/*if( future ) {
+		if( future ) {
 			std::lock_guard<std::mutex> lock( mutex );
 			if( cancelled ) {
 				return true;
 			}
-			HamsterEnvLock sync( env.get() );
-			return cancelled = env->future_is_cancelled( future );
+			return cancelled = future->isCancelled();
 		}
-		return false;*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		return false;
 	}
 
 	bool HamsterBlockingAsyncResult::isEmpty( ) const {
-		/*HT4C_TRY {
-			if( future ) {
-				HamsterEnvLock sync( env.get() );
-				return env->future_is_empty( future );
-			}
-			return true;
+		HT4C_TRY {
+			return future ? future->isEmpty() : true;
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	bool HamsterBlockingAsyncResult::getCells( Common::AsyncResultSink* asyncResultSink ) {
@@ -189,37 +161,30 @@ namespace ht4c { namespace Hamster {
 	}
 
 	bool HamsterBlockingAsyncResult::getCells( Common::AsyncResultSink* asyncResultSink, uint32_t timeoutMsec, bool& timedOut ) {
-		/*HT4C_TRY {
+		HT4C_TRY {
 			timedOut = false;
 			if( future && asyncResultSink && !isCancelled() ) {
-				Hypertable::HamsterGen::ResultSerialized result;
+				Db::Future::Result result;
 				while (true) {
-					try {
-						HamsterEnvLock sync( env.get() );
-						env->future_get_result_serialized( result, future, timeoutMsec );
-					}
-					catch( Hypertable::HamsterGen::ClientException& e ) {
-						if( e.code == Hypertable::Error::REQUEST_TIMEOUT ) {
-							timedOut = true;
-							return false;
-						}
-						throw;
+					if( !future->dequeue(result, timeoutMsec) ) {
+						// nothing left to wait for if all workers have finished
+						timedOut = future->hasOutstanding();
+						return false;
 					}
 
 					// ignore cancelled scanners
-					if( result.id && result.is_scan && !result.is_error && !result.is_empty ) {
+					if( result.isScan && !result.isError && !result.isEmpty ) {
 						std::lock_guard<std::mutex> lock( mutex );
 						if( asyncTableScanners.find(result.id) == asyncTableScanners.end() ) {
 							continue;
 						}
 					}
-					return HamsterAsyncResult::publishResult( result, this, asyncResultSink, true ) && !result.is_empty;
+					return HamsterAsyncResult::publishResult( result, this, asyncResultSink, true ) && (!result.isEmpty || future->hasOutstanding());
 				}
 			}
 			return false;
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
-} }
\ No newline at end of file
+} }
@@ -61,7 +61,7 @@ namespace ht4c { namespace Hamster {
 			/// <param name="env">Hamster environment</param>
 			/// <returns>Hamster future</returns>
 			/// <remarks>Pure native method.</remarks>
-			//TODO Hypertable::HamsterGen::Future get( HamsterEnvPtr env );
+			Db::FuturePtr get( HamsterEnvPtr env );
 
 			#endif
 
@@ -96,7 +96,7 @@ namespace ht4c { namespace Hamster {
 			};
 
 			HamsterEnvPtr env;
-			//TODO Hypertable::HamsterGen::Future future;
+			Db::FuturePtr future;
 			size_t capacity;
 			mutable bool cancelled;
 			mutable std::mutex mutex;
@@ -0,0 +1,323 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+#include "stdafx.h"
+#include "HamsterCompactor.h"
+#include "HamsterEnv.h"
+#include "HamsterException.h"
+
+namespace ht4c { namespace Hamster {
+
+	HamsterCompactor::HamsterCompactor( HamsterEnv* _env, int intervalSec, int _maxCells )
+	: env( _env )
+	, timer( 0 )
+	, maxCells( std::max(1, _maxCells) )
+	, tableId( 0 )
+	, resumeKey( HamsterEnv::KEYSIZE_DB )
+	, resumeAfter( false )
+	, prevCell( HamsterEnv::KEYSIZE_DB )
+	, revsCount( 0 )
+	{
+		memset( columnFamilies, 0, sizeof(columnFamilies) );
+		memset( timeOrderAsc, true, sizeof(timeOrderAsc) );
+
+		DWORD interval = std::max(1, intervalSec) * 1000;
+		if( !::CreateTimerQueueTimer(&timer, 0, timerProc, this, interval, interval, WT_EXECUTELONGFUNCTION) ) {
+			timer = 0;
+		}
+	}
+
+	HamsterCompactor::~HamsterCompactor( ) {
+		if( timer ) {
+			// waits for a running compaction step to complete
+			::DeleteTimerQueueTimer( 0, timer, INVALID_HANDLE_VALUE );
+			timer = 0;
+		}
+	}
+
+	HamsterCompactor::Stats HamsterCompactor::getStats( ) const {
+		std::lock_guard<std::mutex> lock( mutex );
+		return stats;
+	}
+
+	void HamsterCompactor::run( ) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		// continue the current table unless it has been completed or dropped meanwhile
+		std::string schemaSpec;
+		if( !resumeKey.fill() || !findTable(schemaSpec) ) {
+			if( !nextTable(schemaSpec) ) {
+				return;
+			}
+		}
+		loadSchema( schemaSpec );
+
+		std::unique_ptr<hamsterdb::db> tempDb;
+		hamsterdb::db* db = env->findTableDb( tableId );
+		if( !db ) {
+			tempDb.reset( env->openTableDb(tableId) );
+			db = tempDb.get();
+		}
+		HamsterKeyFormat keyFormat = HamsterEnv::getKeyFormat( db );
+
+		uint32_t cellsScanned = 0;
+		uint32_t cellsPurged = 0;
+		bool completed = false;
+		{
+			hamsterdb::cursor cursor( db );
+			hamsterdb::key k;
+			Hypertable::DynamicBuffer erasedKey;
+
+			// where to continue if a pending transaction blocks the cursor
+			const void* conflictKey = resumeKey.base;
+			size_t conflictKeySize = resumeKey.fill();
+			bool conflictAfter = resumeAfter;
+			try {
+				if( resumeKey.fill() ) {
+					k.set_size( static_cast<ham_u16_t>(resumeKey.fill()) );
+					k.set_data( resumeKey.base );
+					cursor.find( &k, 0, resumeAfter ? HAM_FIND_GT_MATCH : HAM_FIND_GEQ_MATCH );
+				}
+				else {
+					cursor.move_first( &k );
+				}
+
+				while( true ) {
+					Hypertable::Key key;
+					if( !HamsterKey::decode(keyFormat, k, timeOrderAsc, key) ) {
+						HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, Hypertable::format("Cannot load key while compacting table %d", tableId).c_str() );
+					}
+
+					++cellsScanned;
+					bool erased = false;
+					if( expired(key) ) {
+						// the cursor becomes nil on erase, keep the key to re-position it
+						erasedKey.clear();
+						erasedKey.add( k.get_data(), k.get_size() );
+						try {
+							cursor.erase();
+							erased = true;
+							++cellsPurged;
+						}
+						catch( hamsterdb::error& e ) {
+							// the key has been modified by a pending transaction
+							if( e.get_errno() != HAM_TXN_CONFLICT ) {
+								throw;
+							}
+						}
+					}
+
+					if( erased ) {
+						conflictKey = erasedKey.base;
+						conflictKeySize = erasedKey.fill();
+						conflictAfter = false;
+
+						k.set_size( static_cast<ham_u16_t>(erasedKey.fill()) );
+						k.set_data( erasedKey.base );
+						cursor.find( &k, 0, HAM_FIND_GEQ_MATCH );
+					}
+					else {
+						// the key is left untouched if the move fails
+						conflictKey = k.get_data();
+						conflictKeySize = k.get_size();
+						conflictAfter = true;
+
+						cursor.move_next( &k );
+					}
+					if( cellsScanned >= maxCells ) {
+						resumeKey.clear();
+						resumeKey.add( k.get_data(), k.get_size() );
+						resumeAfter = false;
+						break;
+					}
+				}
+			}
+			catch( hamsterdb::error& e ) {
+				if( e.get_errno() == HAM_TXN_CONFLICT ) {
+					// end the step, the next one continues once the transaction has been committed
+					if( conflictKey != resumeKey.base ) {
+						resumeKey.clear();
+						resumeKey.add( conflictKey, conflictKeySize );
+					}
+					resumeAfter = conflictAfter;
+				}
+				else if( e.get_errno() == HAM_KEY_NOT_FOUND ) {
+					completed = true;
+					resumeKey.clear();
+					resumeAfter = false;
+					prevCell.clear();
+					revsCount = 0;
+				}
+				else {
+					throw;
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock( mutex );
+		++stats.runs;
+		stats.cellsScanned += cellsScanned;
+		stats.cellsPurged += cellsPurged;
+		if( completed ) {
+			++stats.tablesCompleted;
+		}
+		stats.elapsedMicros += std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+	}
+
+	bool HamsterCompactor::findTable( std::string& schemaSpec ) {
+		hamsterdb::key key( &tableKey[0], static_cast<ham_u16_t>(tableKey.size()) );
+		try {
+			hamsterdb::record record = env->getSysDb()->find( &key );
+			if(  record.get_size() > sizeof(uint16_t)
+				&& *reinterpret_cast<const uint16_t*>(record.get_data()) == tableId ) {
+
+				schemaSpec = reinterpret_cast<const char*>( record.get_data() ) + sizeof(uint16_t);
+				return true;
+			}
+		}
+		catch( hamsterdb::error& e ) {
+			if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
+				throw;
+			}
+		}
+		return false;
+	}
+
+	bool HamsterCompactor::nextTable( std::string& schemaSpec ) {
+		// pick the table following the current one, wrap around at the end
+		std::string firstKey;
+		std::string firstSchemaSpec;
+		uint16_t firstId = 0;
+		std::string nextKey;
+		uint16_t nextId = 0;
+
+		hamsterdb::key key;
+		hamsterdb::record record;
+		hamsterdb::cursor cursor( env->getSysDb() );
+		try {
+			while( true ) {
+				cursor.move_next( &key, &record );
+				if( record.get_size() > sizeof(uint16_t) ) { // namespaces do not have a record
+					std::string k( reinterpret_cast<const char*>(key.get_data()), key.get_size() );
+					if( firstKey.empty() ) {
+						firstKey = k;
+						firstId = *reinterpret_cast<const uint16_t*>( record.get_data() );
+						firstSchemaSpec = reinterpret_cast<const char*>( record.get_data() ) + sizeof(uint16_t);
+					}
+					if( k > tableKey ) {
+						nextKey = k;
+						nextId = *reinterpret_cast<const uint16_t*>( record.get_data() );
+						schemaSpec = reinterpret_cast<const char*>( record.get_data() ) + sizeof(uint16_t);
+						break;
+					}
+				}
+			}
+		}
+		catch( hamsterdb::error& e ) {
+			if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
+				throw;
+			}
+		}
+
+		if( nextKey.empty() ) {
+			if( firstKey.empty() ) {
+				return false;
+			}
+			nextKey = firstKey;
+			nextId = firstId;
+			schemaSpec = firstSchemaSpec;
+		}
+
+		tableKey = nextKey;
+		tableId = nextId;
+		resumeKey.clear();
+		resumeAfter = false;
+		prevCell.clear();
+		revsCount = 0;
+		return true;
+	}
+
+	void HamsterCompactor::loadSchema( const std::string& schemaSpec ) {
+		memset( columnFamilies, 0, sizeof(columnFamilies) );
+		memset( timeOrderAsc, true, sizeof(timeOrderAsc) );
+
+		int64_t now = Hypertable::get_ts64();
+		Hypertable::SchemaPtr schema( Hypertable::Schema::new_instance(schemaSpec) );
+		const Hypertable::ColumnFamilySpecs& families = schema->get_column_families();
+		for each( const Hypertable::ColumnFamilySpec* cf in families ) {
+			if( cf->get_deleted() || cf->get_option_counter() ) {
+				continue;
+			}
+
+			ColumnFamily& family = columnFamilies[cf->get_id()];
+			family.cutoffTime = cf->get_option_ttl() ? now - ((int64_t)cf->get_option_ttl() * 1000000000LL) : Hypertable::TIMESTAMP_MIN;
+			family.maxVersions = cf->get_option_max_versions();
+			family.valid = true;
+			timeOrderAsc[cf->get_id()] = !cf->get_option_time_order_desc();
+		}
+	}
+
+	bool HamsterCompactor::expired( const Hypertable::Key& key ) {
+		const ColumnFamily& family = columnFamilies[key.column_family_code];
+		if( !family.valid ) {
+			return false;
+		}
+
+		// cutoff time
+		if( key.timestamp < family.cutoffTime ) {
+			return true;
+		}
+
+		// versions are stored newest first, unless the column family has been declared as time order desc
+		if( family.maxVersions && timeOrderAsc[key.column_family_code] ) {
+			const uint8_t* cellKey = reinterpret_cast<const uint8_t*>( key.row );
+			size_t cellKeyLen = key.flag_ptr - cellKey + 1;
+			if( prevCell.fill() != cellKeyLen || memcmp(cellKey, prevCell.base, cellKeyLen) ) {
+				prevCell.clear();
+				prevCell.add( cellKey, cellKeyLen );
+				revsCount = 0;
+			}
+			if( ++revsCount > family.maxVersions ) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	VOID HamsterCompactor::timerProc( void* param, BOOLEAN /*timerOrWaitFired*/ ) {
+		HamsterCompactor* compactor = reinterpret_cast<HamsterCompactor*>( param );
+		HamsterEnvLock sync( compactor->env );
+		try {
+			compactor->run();
+		}
+		catch( ... ) {
+			// skip the rest of the table, the next step continues with the following table
+			compactor->resumeKey.clear();
+			compactor->resumeAfter = false;
+		}
+	}
+
+} }
@@ -0,0 +1,128 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#pragma once
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+#include <mutex>
+
+namespace ht4c { namespace Hamster {
+
+	class HamsterEnv;
+
+	/// <summary>
+	/// Represents the hamster background compaction, which purges cells past their TTL
+	/// and beyond the max versions of their column family.
+	/// </summary>
+	/// <remarks>
+	/// The compaction walks the tables incrementally, each run examines at most a configured
+	/// number of cells while holding the environment lock and resumes at the next key.
+	/// </remarks>
+	class HamsterCompactor {
+
+		public:
+
+			/// <summary>
+			/// Represents the compaction statistics.
+			/// </summary>
+			struct Stats {
+				uint64_t runs;
+				uint64_t cellsScanned;
+				uint64_t cellsPurged;
+				uint64_t tablesCompleted;
+				uint64_t elapsedMicros;
+
+				Stats( )
+					: runs( 0 )
+					, cellsScanned( 0 )
+					, cellsPurged( 0 )
+					, tablesCompleted( 0 )
+					, elapsedMicros( 0 )
+				{
+				}
+			};
+
+			/// <summary>
+			/// Creates a new HamsterCompactor instance and starts the compaction timer.
+			/// </summary>
+			/// <param name="env">Hamster environment</param>
+			/// <param name="intervalSec">Interval between two compaction runs [s]</param>
+			/// <param name="maxCells">Max number of cells examined per compaction run</param>
+			HamsterCompactor( HamsterEnv* env, int intervalSec, int maxCells );
+
+			/// <summary>
+			/// Stops the compaction timer and destroys the HamsterCompactor instance.
+			/// </summary>
+			virtual ~HamsterCompactor( );
+
+			/// <summary>
+			/// Returns the compaction statistics.
+			/// </summary>
+			/// <returns>Compaction statistics</returns>
+			Stats getStats( ) const;
+
+			/// <summary>
+			/// Runs a single compaction step.
+			/// </summary>
+			/// <remarks>The caller must hold the environment lock.</remarks>
+			void run( );
+
+		private:
+
+			struct ColumnFamily {
+				int64_t cutoffTime;
+				uint32_t maxVersions;
+				bool valid;
+			};
+
+			enum {
+				MAX_CF = 256
+			};
+
+			bool findTable( std::string& schemaSpec );
+			bool nextTable( std::string& schemaSpec );
+			void loadSchema( const std::string& schemaSpec );
+			bool expired( const Hypertable::Key& key );
+			static VOID CALLBACK timerProc( void* param, BOOLEAN timerOrWaitFired );
+
+			HamsterCompactor( ) { }
+			HamsterCompactor( const HamsterCompactor& ) { }
+			HamsterCompactor& operator = ( const HamsterCompactor& ) { return *this; }
+
+			HamsterEnv* env;
+			HANDLE timer;
+			uint32_t maxCells;
+			std::string tableKey;
+			uint16_t tableId;
+			ColumnFamily columnFamilies[MAX_CF];
+			bool timeOrderAsc[MAX_CF];
+			Hypertable::DynamicBuffer resumeKey;
+			bool resumeAfter;
+			Hypertable::DynamicBuffer prevCell;
+			uint32_t revsCount;
+			Stats stats;
+			mutable std::mutex mutex;
+	};
+
+} }
@@ -26,6 +26,8 @@
 #include "stdafx.h"
 #include "HamsterException.h"
 
+#include "ht4c.Common/MutatorFlags.h"
+
 namespace ht4c { namespace Hamster { namespace Db {
 
 	namespace Util {
@@ -59,6 +61,14 @@ namespace ht4c { namespace Hamster { namespace Db {
 				return name && strstr(name, preffix.c_str()) == name;
 			}
 
+			inline size_t CellSize( const Hypertable::Cell& cell ) {
+				return sizeof(Hypertable::Cell)
+						 + strlen( cell.row_key )
+						 + (cell.column_family ? strlen(cell.column_family) : 0)
+						 + (cell.column_qualifier ? strlen(cell.column_qualifier) : 0)
+						 + cell.value_len;
+			}
+
 	}
 
 	Client::Client( HamsterEnvPtr _env )
@@ -549,7 +559,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 	: ns( _ns )
 	, name( _name )
 	, id( 0 )
-	, db( 0 ) {
+	, db( 0 )
+	, keyFormat( KF_Serialized ) {
 		init();
 	}
 
@@ -558,7 +569,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 	, name( _name )
 	, schemaSpec( _schema )
 	, id( _id )
-	, db( _db ) {
+	, db( _db )
+	, keyFormat( _db ? HamsterEnv::getKeyFormat(_db) : KF_Serialized ) {
 		init();
 	}
 
@@ -568,7 +580,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 	, schemaSpec( other.schemaSpec )
 	, schema( other.schema )
 	, id( other.id )
-	, db( other.db ) {
+	, db( other.db )
+	, keyFormat( other.keyFormat ) {
 		init();
 	}
 
@@ -606,6 +619,26 @@ namespace ht4c { namespace Hamster { namespace Db {
 		return new Db::Scanner( this, scanSpec, flags );
 	}
 
+	Db::MutatorAsyncPtr Table::createMutatorAsync( Db::FuturePtr future, int32_t flags ) {
+		if( !id ) {
+			HT4C_HAMSTER_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Invalid identifier for table '%s'", getFullName()).c_str() );
+		}
+		if( !db ) {
+			HT4C_HAMSTER_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Table '%s' already disposed", getFullName()).c_str() );
+		}
+		return new Db::MutatorAsync( this, future, flags );
+	}
+
+	Db::ScannerAsyncPtr Table::createScannerAsync( const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags ) {
+		if( !id ) {
+			HT4C_HAMSTER_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Invalid identifier for table '%s'", getFullName()).c_str() );
+		}
+		if( !db ) {
+			HT4C_HAMSTER_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Table '%s' already disposed", getFullName()).c_str() );
+		}
+		return new Db::ScannerAsync( this, scanSpec, future, flags );
+	}
+
 	Hypertable::SchemaPtr Table::getSchema() {
 		if( !schema ) {
 			schema = Hypertable::SchemaPtr(Hypertable::Schema::new_instance(schemaSpec) );
@@ -669,6 +702,7 @@ namespace ht4c { namespace Hamster { namespace Db {
 		toKey( key );
 		fromRecord( getEnv()->getSysDb()->find(&key) );
 		db = getEnv()->openTable( id, this );
+		keyFormat = HamsterEnv::getKeyFormat( db );
 	}
 
 	void Table::refresh( ) {
@@ -703,7 +737,17 @@ namespace ht4c { namespace Hamster { namespace Db {
 	, flushInterval( _flushInterval )
 	, buf( HamsterEnv::KEYSIZE_DB )
 	, db( _table->getDb() )
+	, keyFormat( _table->getKeyFormat() )
 	, schema( _table->getSchema().get() )
+	, batched( _table->getEnv()->hasTransactions() )
+	, txnActive( false )
+	, batchCells( 0 )
+	, batchBytes( 0 )
+	, batchStart( 0 )
+	, batchError( 0 )
+	, sortedInput( (_flags & Common::MF_SortedInput) != 0 )
+	, appendCursor( 0 )
+	, lastColumnFamilyCode( 0 )
 	{
 		memset( timeOrderAsc, true, sizeof(timeOrderAsc) );
 		const Hypertable::ColumnFamilySpecs& families = schema->get_column_families();
@@ -713,6 +757,16 @@ namespace ht4c { namespace Hamster { namespace Db {
 	}
 
 	Mutator::~Mutator( ) {
+		closeAppendCursor();
+		if( txnActive ) {
+			try {
+				txn.abort();
+			}
+			catch( hamsterdb::error& ) {
+			}
+			txnActive = false;
+			table->getEnv()->detachBatch( this );
+		}
 		schema = 0;
 		db = 0;
 		table = 0;
@@ -728,7 +782,9 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 	void Mutator::set( const Hypertable::Cells& cells ) {
 		for each( const Hypertable::Cell& cell in cells ) {
-			cell.sanity_check();
+			if( !sortedInput ) {
+				cell.sanity_check();
+			}
 
 			Hypertable::Key key;
 			toKey( schema
@@ -749,10 +805,11 @@ namespace ht4c { namespace Hamster { namespace Db {
 			HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, Hypertable::format("Invalid delete flag '%d'", key.flag).c_str() );
 		}
 
-		del( key );
+		set( key, 0, 0 );
 	}
 
 	void Mutator::flush( ) {
+		commit();
 		if( table ) {
 			HamsterEnv* env = table->getEnv();
 				if( env ) {
@@ -761,6 +818,87 @@ namespace ht4c { namespace Hamster { namespace Db {
 		}
 	}
 
+	void Mutator::commit( ) {
+		checkBatch();
+		closeAppendCursor();
+		if( txnActive ) {
+			txnActive = false;
+			batchCells = 0;
+			batchBytes = 0;
+			table->getEnv()->detachBatch( this );
+			try {
+				txn.commit();
+			}
+			catch( hamsterdb::error& ) {
+				try {
+					txn.abort();
+				}
+				catch( hamsterdb::error& ) {
+				}
+				throw;
+			}
+		}
+	}
+
+	void Mutator::commitPending( ) {
+		// Called by the flush interval timer, failures are reported
+		// on the next mutator call
+		try {
+			if( !batchError ) {
+				commit();
+			}
+		}
+		catch( hamsterdb::error& e ) {
+			batchError = e.get_errno();
+		}
+	}
+
+	hamsterdb::txn* Mutator::beginBatch( ) {
+		checkBatch();
+		if( !batched ) {
+			return 0;
+		}
+		if( !txnActive ) {
+			// Scanners and mutators running into the keys of an open batch commit it, see
+			// HamsterEnv::commitBatches, and hamsterdb flushes committed transactions oldest
+			// first, so the batch lifetime is bounded by TxnMaxAgeMsec
+			txn = table->getEnv()->getEnv()->begin();
+			txnActive = true;
+			batchStart = ::GetTickCount64();
+			table->getEnv()->attachBatch( this );
+		}
+		return &txn;
+	}
+
+	void Mutator::endBatch( uint32_t size ) {
+		if( txnActive ) {
+			++batchCells;
+			batchBytes += size;
+
+			HamsterEnv* env = table->getEnv();
+			if(  batchCells >= env->getTxnMaxCells()
+				|| batchBytes >= env->getTxnMaxBytes()
+				|| ::GetTickCount64() - batchStart >= env->getTxnMaxAge() ) {
+				commit();
+			}
+		}
+	}
+
+	void Mutator::closeAppendCursor( ) {
+		if( appendCursor ) {
+			delete appendCursor;
+			appendCursor = 0;
+		}
+	}
+
+	void Mutator::checkBatch( ) {
+		if( batchError ) {
+			ham_status_t st = batchError;
+			batchError = 0;
+			throw hamsterdb::error( st );
+		}
+	}
+
 	void Mutator::insert( Hypertable::Key& key, const void* value, uint32_t valueLength ) {
 		hamsterdb::key k;
 		toKey( key, k );
@@ -769,13 +907,25 @@ namespace ht4c { namespace Hamster { namespace Db {
 		r.set_size( valueLength );
 		r.set_data( const_cast<void*>(value) );
 
-		db->insert( &k, &r, HAM_OVERWRITE );
+		hamsterdb::txn* t = beginBatch();
+		if( sortedInput ) {
+			// Hamster verifies the append hint by a single key comparison and
+			// falls back to a regular insert if the key does not append
+			if( !appendCursor ) {
+				appendCursor = new hamsterdb::cursor( db, t );
+			}
+			appendCursor->insert( &k, &r, HAM_OVERWRITE|HAM_HINT_APPEND );
+		}
+		else {
+			db->insert( t, &k, &r, HAM_OVERWRITE );
+		}
+		endBatch( k.get_size() + valueLength );
 	}
 
 	void Mutator::toKey( const Hypertable::Key& key, hamsterdb::key& k ) {
 		buf.clear();
-		Hypertable::create_key_and_append( buf
-			, Hypertable::FLAG_INSERT // always flag INSERT stored, key.flag
+		HamsterKey::encode( keyFormat
+			, buf
 			, key.row
 			, key.column_family_code
 			, key.column_qualifier
@@ -801,11 +951,15 @@ namespace ht4c { namespace Hamster { namespace Db {
 				HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, "Column family not specified" );
 			}
 
-			Hypertable::ColumnFamilySpec* cf = schema->get_column_family( columnFamily );
-			if( !cf ) {
-				HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, Hypertable::format("Bad column family '%s'", columnFamily).c_str() );
+			if( !lastColumnFamilyCode || lastColumnFamily != columnFamily ) {
+				Hypertable::ColumnFamilySpec* cf = schema->get_column_family( columnFamily );
+				if( !cf ) {
+					HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, Hypertable::format("Bad column family '%s'", columnFamily).c_str() );
+				}
+				lastColumnFamily = columnFamily;
+				lastColumnFamilyCode = static_cast<uint8_t>( cf->get_id() );
 			}
-			fullKey.column_family_code = static_cast<uint8_t>( cf->get_id() );
+			fullKey.column_family_code = lastColumnFamilyCode;
 		}
 		else {
 			fullKey.column_family_code = 0;
@@ -823,11 +977,24 @@ namespace ht4c { namespace Hamster { namespace Db {
 	}
 
 	void Mutator::set( Hypertable::Key& key, const void* value, uint32_t valueLength ) {
-		if( key.flag == Hypertable::FLAG_INSERT ) {
-			insert( key, value, valueLength );
-		}
-		else {
-			del( key );
+		for( bool retry = true; ; retry = false ) {
+			try {
+				if( key.flag == Hypertable::FLAG_INSERT ) {
+					insert( key, value, valueLength );
+				}
+				else {
+					del( key );
+				}
+				return;
+			}
+			catch( hamsterdb::error& e ) {
+				if( e.get_errno() != HAM_TXN_CONFLICT || !retry ) {
+					throw;
+				}
+			}
+
+			// the key belongs to the open batch of another mutator
+			table->getEnv()->commitBatches( false );
 		}
 	}
 
@@ -835,23 +1002,24 @@ namespace ht4c { namespace Hamster { namespace Db {
 		hamsterdb::key k;
 		toKey( key, k );
 
+		const uint32_t size = k.get_size();
+		hamsterdb::txn* t = beginBatch();
 		try {
 			if( key.flag >= Hypertable::FLAG_DELETE_CELL_VERSION ) {
-				db->erase( &k );
+				db->erase( t, &k );
 			}
 			else {
 				hamsterdb::cursor cursor;
-				cursor.create( db );
+				cursor.create( db, t );
 				cursor.find( &k, 0, HAM_FIND_GEQ_MATCH );
 				while( true ) {
-					Hypertable::SerializedKey sk( reinterpret_cast<const uint8_t*>(k.get_data()) );
-					if( strcmp(sk.row(), key.row) != 0 ) {
+					if( strcmp(HamsterKey::row(keyFormat, k), key.row) != 0 ) {
 						break;
 					}
 
 					if( key.flag > Hypertable::FLAG_DELETE_ROW || key.timestamp > Hypertable::AUTO_ASSIGN ) {
 						Hypertable::Key _key;
-						if( !_key.load(sk) ) {
+						if( !HamsterKey::decode(keyFormat, k, timeOrderAsc, _key) ) {
 							HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, "Cannot load key" );
 						}
 
@@ -892,33 +1060,74 @@ namespace ht4c { namespace Hamster { namespace Db {
 				throw;
 			}
 		}
+		endBatch( size );
 	}
 
-	MutatorAsync::MutatorAsync( Db::TablePtr _table )
-	: table( _table )
-	, db( _table->getDb() )
-	, schema( _table->getSchema().get() ) {
+	MutatorAsync::MutatorAsync( Db::TablePtr _table, Db::FuturePtr future, int32_t flags )
+	: Common::MutatorAsync( future )
+	, table( _table )
+	, mutator( _table->createMutator(flags, 0) )
+	{
 	}
 
 	MutatorAsync::~MutatorAsync( ) {
-		schema = 0;
-		db = 0;
+		// commit the cells written and release the mutator under the lock,
+		// closing its append cursor or batch transaction races other writers
+		{
+			HamsterEnvLock sync( getEnv() );
+			try {
+				mutator->flush();
+			}
+			catch( hamsterdb::error& ) {
+			}
+			catch( Hypertable::Exception& ) {
+			}
+			mutator = 0;
+		}
 		table = 0;
 	}
 
+	void MutatorAsync::write( const Hypertable::Cells& cells ) {
+		HT4C_TRY {
+			HamsterEnvLock sync( getEnv() );
+			mutator->set( cells );
+		}
+		HT4C_HAMSTER_RETHROW
+	}
+
+	void MutatorAsync::flushWritten( ) {
+		HamsterEnvLock sync( getEnv() );
+		mutator->flush();
+	}
+
+	void MutatorAsync::idle( ) {
+		HT4C_TRY {
+			// queue drained, do not keep the batch open while idle
+			HamsterEnvLock sync( getEnv() );
+			mutator->commit();
+		}
+		HT4C_HAMSTER_RETHROW
+	}
+
 	Scanner::Scanner( Db::TablePtr _table, const Hypertable::ScanSpec& _scanSpec, uint32_t _flags )
 	: table( _table )
 	, flags( _flags )
 	, db( _table->getDb() )
-	, buf( 4 * 1024 )
+	, transactions( _table->getEnv()->hasTransactions() )
+	, txnActive( false )
+	, prefetchIndex( 0 )
+	, prefetchEos( false )
 	, reader( 0 )
 	, scanSpec( _scanSpec )
 	{
-		cursor.create( db );
+		// with transactions, the cursor is bound to a read transaction per batch, see beginRead
+		if( !transactions ) {
+			cursor.create( db );
+		}
 
 		if( scanSpec.get().row_intervals.empty() ) {
 			if( scanSpec.get().cell_intervals.empty() ) {
-				reader = new Reader( &cursor, _table->getSchema(), scanSpec.get() );
+				reader = new Reader( &cursor, _table->getKeyFormat(), _table->getSchema(), scanSpec.get() );
 			}
 			else {
 				Hypertable::CellIntervals& cellIntervals = scanSpec.get().cell_intervals;
@@ -930,11 +1139,11 @@ namespace ht4c { namespace Hamster { namespace Db {
 						ci->end_row = Hypertable::Key::END_ROW_MARKER;
 					}
 				}
-				reader = new ReaderCellIntervals( &cursor, _table->getSchema(), scanSpec.get() );
+				reader = new ReaderCellIntervals( &cursor, _table->getKeyFormat(), _table->getSchema(), scanSpec.get() );
 			}
 		}
 		else if (scanSpec.get().scan_and_filter_rows) {
-			reader = new ReaderScanAndFilter( &cursor, _table->getSchema(), scanSpec.get() );
+			reader = new ReaderScanAndFilter( &cursor, _table->getKeyFormat(), _table->getSchema(), scanSpec.get() );
 		}
 		else {
 			Hypertable::RowIntervals& rowIntervals = scanSpec.get().row_intervals;
@@ -946,7 +1155,7 @@ namespace ht4c { namespace Hamster { namespace Db {
 					ri->end = Hypertable::Key::END_ROW_MARKER;
 				}
 			}
-			reader = new ReaderRowIntervals( &cursor, _table->getSchema(), scanSpec.get() );
+			reader = new ReaderRowIntervals( &cursor, _table->getKeyFormat(), _table->getSchema(), scanSpec.get() );
 		}
 	}
 
@@ -955,27 +1164,142 @@ namespace ht4c { namespace Hamster { namespace Db {
 			delete reader;
 			reader = 0;
 		}
+		endRead();
 		db = 0;
 	}
 
 	bool Scanner::nextCell( Hypertable::Cell& cell ) {
-		try {
-			Hypertable::Key key;
-			if( reader->nextCell(buf, key, cell) ) {
+		// cells are read in batches, so that a read transaction does not outlive the call
+		if( !prefetch || prefetchIndex >= prefetch->get().size() ) {
+			if( prefetchEos ) {
+				return false;
+			}
+
+			prefetch = std::make_shared<Hypertable::CellsBuilder>( PREFETCH_CELLS );
+			prefetchIndex = 0;
+
+			uint32_t size;
+			prefetchEos = !nextCells( *prefetch, PREFETCH_CELLS, PREFETCH_BYTES, size );
+			if( prefetch->get().empty() ) {
+				return false;
+			}
+		}
+
+		cell = prefetch->get()[prefetchIndex++];
+		return true;
+	}
+
+	bool Scanner::nextCells( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size ) {
+		size = 0;
+		uint32_t count = 0;
+		while( true ) {
+			beginRead();
+			try {
+				// cells refer to the cursor's key and record, copy them once into the builder's arena
+				Hypertable::Key key;
+				Hypertable::Cell cell;
+				for( ; count < maxCells && size < maxBytes; ++count ) {
+					if( !reader->nextCell(0, key, cell) ) {
+						endRead();
+						return false;
+					}
+					cells.add( cell, true );
+					size += static_cast<uint32_t>( Util::CellSize(cell) );
+				}
+				endRead();
 				return true;
 			}
+			catch( hamsterdb::error& e ) {
+				endRead();
+				if( e.get_errno() == HAM_KEY_NOT_FOUND ) {
+					return false;
+				}
+				if( e.get_errno() != HAM_TXN_CONFLICT ) {
+					throw;
+				}
+			}
+			catch( ... ) {
+				endRead();
+				throw;
+			}
+
+			// Cursor moves skip the keys of an open batch but a find fails on them,
+			// commit the open batches and repeat the pending seek. The scanner reads
+			// under the shared lock, conflicts only occur with transactions enabled.
+			getEnv()->commitBatches( true );
 		}
-		catch( hamsterdb::error& e ) {
-			if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
+	}
+
+	void Scanner::beginRead( ) {
+		// A private read-only transaction gives the cursor its own key and record buffers,
+		// which allows scanners to read concurrently under a shared lock. Hamster flushes
+		// committed transactions oldest first, an open read transaction would hold them
+		// back, so the transaction lasts for one batch only.
+		if( transactions && !txnActive ) {
+			ham_txn_t* t = 0;
+			ham_status_t st = ham_txn_begin( &t, ham_db_get_env(db->get_handle()), 0, 0, HAM_TXN_READ_ONLY );
+			if( st ) {
+				throw hamsterdb::error( st );
+			}
+			txn = hamsterdb::txn( t );
+			txnActive = true;
+
+			try {
+				cursor.create( db, &txn );
+			}
+			catch( hamsterdb::error& ) {
+				txnActive = false;
+				txn.abort();
 				throw;
 			}
+			reader->resume();
 		}
+	}
 
-		return false;
+	void Scanner::endRead( ) {
+		if( txnActive ) {
+			txnActive = false;
+			try {
+				reader->suspend();
+			}
+			catch( hamsterdb::error& ) {
+			}
+			try {
+				cursor.close();
+				txn.abort();
+			}
+			catch( hamsterdb::error& ) {
+			}
+		}
 	}
 
-	Scanner::Reader::Reader( hamsterdb::cursor* _cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec )
+	Scanner::KeyRange::KeyRange( const Hypertable::ScanSpec& scanSpec ) {
+		literalPrefix( scanSpec.row_regexp, prefix );
+	}
+
+	void Scanner::KeyRange::literalPrefix( const char* regexp, std::string& prefix ) {
+		prefix.clear();
+
+		// only anchored regular expressions without alternations have a literal prefix
+		if( !regexp || *regexp != '^' || strchr(regexp, '|') ) {
+			return;
+		}
+
+		for( const char* p = regexp + 1; *p; ++p ) {
+			if( strchr("\\.^$?*+()[]{}", *p) ) {
+				// the preceding character might be optional
+				if( !prefix.empty() && (*p == '?' || *p == '*' || *p == '{') ) {
+					prefix.resize( prefix.size() - 1 );
+				}
+				break;
+			}
+			prefix += *p;
+		}
+	}
+
+	Scanner::Reader::Reader( hamsterdb::cursor* _cursor, HamsterKeyFormat _keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec )
 	: cursor( _cursor )
+	, keyFormat( _keyFormat )
 	, scanContext( new ScanContext(scanSpec, schema) )
 	, prevKey( HamsterEnv::KEYSIZE_DB )
 	, prevColumnFamilyCode( -1 )
@@ -985,8 +1309,31 @@ namespace ht4c { namespace Hamster { namespace Db {
 	, cellCount( 0 )
 	, cellPerFamilyCount( 0 )
 	, eos( false )
+	, keyRange( scanSpec )
+	, started( false )
+	, seekKey( HamsterEnv::KEYSIZE_DB )
+	, seekPending( false )
+	, resumeKey( HamsterEnv::KEYSIZE_DB )
+	, resumeKeyValid( false )
+	, resumePending( false )
+	, skipCount( 0 )
 	{
 		scanContext->initialize();
+
+		memset( timeOrderAsc, true, sizeof(timeOrderAsc) );
+		Hypertable::ColumnFamilySpecs& families = schema->get_column_families();
+		for each( Hypertable::ColumnFamilySpec* cf in families ) {
+			timeOrderAsc[cf->get_id()] = !cf->get_option_time_order_desc();
+		}
+
+		// next wanted column family for each column family code, 0 if none
+		uint8_t next = 0;
+		for( int cf = MAX_CF - 1; cf >= 0; --cf ) {
+			nextColumnFamilyCode[cf] = next;
+			if( scanContext->familyMask[cf] ) {
+				next = static_cast<uint8_t>( cf );
+			}
+		}
 	}
 
 	Scanner::Reader::~Reader() {
@@ -995,12 +1342,11 @@ namespace ht4c { namespace Hamster { namespace Db {
 		cursor = 0;
 	}
 
-	bool Scanner::Reader::nextCell( Hypertable::DynamicBuffer& buf, Hypertable::Key& key, Hypertable::Cell& cell ) {
+	bool Scanner::Reader::nextCell( Hypertable::DynamicBuffer* buf, Hypertable::Key& key, Hypertable::Cell& cell ) {
 		hamsterdb::key k;
 		for( bool moved = moveNext(k); moved && !eos; moved = moveNext(k) ) {
-			Hypertable::SerializedKey sk( reinterpret_cast<const uint8_t*>(k.get_data()) );
-			if( filterRow(k, sk.row()) ) {
-				if( !key.load(sk) ) {
+			if( filterRow(k, HamsterKey::row(keyFormat, k)) ) {
+				if( !HamsterKey::decode(keyFormat, k, timeOrderAsc, key) ) {
 					HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, "Cannot load key" );
 				}
 
@@ -1017,10 +1363,136 @@ namespace ht4c { namespace Hamster { namespace Db {
 	}
 
 	bool Scanner::Reader::moveNext( hamsterdb::key& k ) {
-		cursor->move_next( &k );
+		if( !started ) {
+			started = true;
+			if( keyRange.hasStart() ) {
+				seek( keyRange.getStart(), 0, 0, Hypertable::TIMESTAMP_MAX );
+			}
+		}
+
+		moveNextOrSeek( k );
+
+		// stop at the upper bound instead of walking to the end of the table
+		if( keyRange.hasEnd() ) {
+			if( keyRange.beyondEnd(HamsterKey::row(keyFormat, k)) ) {
+				eos = true;
+				return false;
+			}
+		}
+
 		return true;
 	}
 
+	void Scanner::Reader::moveNextOrSeek( hamsterdb::key& k ) {
+		// a seek or resume stays pending until the find succeeded, see Scanner::nextCells
+		if( seekPending ) {
+			k.set_size( seekKey.fill() );
+			k.set_data( (void*)seekKey.base );
+			cursor->find( &k, 0, HAM_FIND_GEQ_MATCH );
+
+			seekPending = false;
+			resumePending = false;
+		}
+		else if( resumePending ) {
+			// the cursor has been re-created, continue after the last key read
+			k.set_size( resumeKey.fill() );
+			k.set_data( (void*)resumeKey.base );
+			cursor->find( &k, 0, HAM_FIND_GT_MATCH );
+
+			resumePending = false;
+		}
+		else {
+			cursor->move_next( &k );
+		}
+	}
+
+	void Scanner::Reader::suspend( ) {
+		// the cursor is about to be closed, remember its position
+		// unless a pending seek will position it anyway
+		resumeKeyValid = false;
+		if( seekPending ) {
+			return;
+		}
+		if( !resumePending ) {
+			try {
+				hamsterdb::key k;
+				cursor->move( &k, 0, 0 );
+				resumeKey.set( k.get_data(), k.get_size() );
+				resumeKeyValid = true;
+			}
+			catch( hamsterdb::error& e ) {
+				// nothing has been read yet
+				if( e.get_errno() != HAM_CURSOR_IS_NIL ) {
+					throw;
+				}
+			}
+		}
+		else {
+			resumeKeyValid = true;
+		}
+	}
+
+	void Scanner::Reader::resume( ) {
+		resumePending = resumeKeyValid;
+	}
+
+	void Scanner::Reader::seek( const char* row, uint8_t columnFamilyCode, const char* columnQualifier, int64_t timestamp ) {
+		seekKey.clear();
+		HamsterKey::encode( keyFormat
+			, seekKey
+			, row
+			, columnFamilyCode
+			, columnQualifier
+			, timestamp
+			, Hypertable::AUTO_ASSIGN
+			, timeOrderAsc[columnFamilyCode] );
+
+		seekPending = true;
+	}
+
+	void Scanner::Reader::skipColumnFamily( const Hypertable::Key& key ) {
+		// step over short runs, seek is more expensive than a few cursor moves
+		if( ++skipCount < MAX_SEQUENTIAL_SKIPS ) {
+			return;
+		}
+
+		skipCount = 0;
+		uint8_t columnFamilyCode = nextColumnFamilyCode[key.column_family_code];
+		if( columnFamilyCode ) {
+			// the first version is the newest one, unless the column family has been declared as time order desc
+			seek( key.row, columnFamilyCode, 0, timeOrderAsc[columnFamilyCode] ? Hypertable::TIMESTAMP_MAX : Hypertable::TIMESTAMP_MIN );
+		}
+		else {
+			// no more wanted column families in this row, continue with the next row
+			std::string row( key.row, key.row_len );
+			row += '\x01';
+			seek( row.c_str(), 0, 0, Hypertable::TIMESTAMP_MAX );
+		}
+	}
+
+	void Scanner::Reader::skipColumnQualifier( const Hypertable::Key& key ) {
+		if( ++skipCount < MAX_SEQUENTIAL_SKIPS ) {
+			return;
+		}
+
+		skipCount = 0;
+		std::string columnQualifier( key.column_qualifier, key.column_qualifier_len );
+		columnQualifier += '\x01';
+		seek( key.row, key.column_family_code, columnQualifier.c_str(), timeOrderAsc[key.column_family_code] ? Hypertable::TIMESTAMP_MAX : Hypertable::TIMESTAMP_MIN );
+	}
+
+	void Scanner::Reader::seekTimeInterval( const Hypertable::Key& key ) {
+		// versions are stored newest first, unless the column family has been declared as time order desc
+		if( timeOrderAsc[key.column_family_code] ) {
+			if( key.timestamp >= scanContext->timeInterval.second ) {
+				seek( key.row, key.column_family_code, key.column_qualifier, scanContext->timeInterval.second - 1 );
+			}
+		}
+		else if( key.timestamp < scanContext->timeInterval.first ) {
+			seek( key.row, key.column_family_code, key.column_qualifier, scanContext->timeInterval.first );
+		}
+	}
+
 	bool Scanner::Reader::filterRow( hamsterdb::key& k, const char* row ) {
 		// row set
 		if( !scanContext->rowset.empty() ) {
@@ -1051,15 +1523,14 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 	const Hypertable::ColumnFamilySpec* Scanner::Reader::filterCell( hamsterdb::key& k, const Hypertable::Key& key ) {
 		if( !scanContext->familyMask[key.column_family_code] ) {
+			skipColumnFamily( key );
 			return 0;
 		}
 
 		CellFilterInfo& cfi = scanContext->familyInfo[key.column_family_code];
 
-		// cutoff time
+		// cutoff time, expired cells are purged by the background compaction
 		if( key.timestamp < cfi.cutoffTime ) {
-			cursor->erase( );
-
 			return 0;
 		}
 
@@ -1067,6 +1538,7 @@ namespace ht4c { namespace Hamster { namespace Db {
 		if(  key.timestamp < scanContext->timeInterval.first
 			|| key.timestamp >= scanContext->timeInterval.second ) {
 
+			seekTimeInterval( key );
 			return 0;
 		}
 
@@ -1104,9 +1576,12 @@ namespace ht4c { namespace Hamster { namespace Db {
 		// revision limit
 		++revsCount;
 		if( revsLimit && revsCount > revsLimit ) {
+			skipColumnQualifier( key );
 			return 0;
 		}
 
+		skipCount = 0;
+
 		// column qualifier match
 		if( cfi.hasQualifierRegexpFilter() ) {
 			bool cached, match;
@@ -1126,14 +1601,17 @@ namespace ht4c { namespace Hamster { namespace Db {
 		return scanContext->columnFamilies[key.column_family_code];
 	}
 
-	bool Scanner::Reader::getCell( Hypertable::DynamicBuffer& buf, const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell ) {
+	bool Scanner::Reader::getCell( Hypertable::DynamicBuffer* buf, const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell ) {
 		if( !scanContext->valueRegexp ) {
 			if( !checkCellLimits(key) ) {
 				return false;
 			}
 		}
 
-		buf.clear();
+		// without a buffer the cell refers to the cursor's key and record, valid until the cursor moves
+		if( buf ) {
+			buf->clear();
+		}
 
 		cell.value = 0;
 		cell.value_len = 0;
@@ -1164,9 +1642,12 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 			if( !scanContext->keysOnly ) {
 				cell.value_len = record.get_size();
-				if( cell.value_len ) {
-					buf.ensure( key.row_len + 1 + key.column_qualifier_len + 1 + cell.value_len + 1 );
-					cell.value = reinterpret_cast<const uint8_t*>( buf.add(record.get_data(), cell.value_len) );
+				if( cell.value_len && !buf ) {
+					cell.value = reinterpret_cast<const uint8_t*>( record.get_data() );
+				}
+				else if( cell.value_len ) {
+					buf->ensure( key.row_len + 1 + key.column_qualifier_len + 1 + cell.value_len + 1 );
+					cell.value = reinterpret_cast<const uint8_t*>( buf->add(record.get_data(), cell.value_len) );
 				}
 				else {
 					cell.value = reinterpret_cast<const uint8_t*>( "" );
@@ -1174,10 +1655,16 @@ namespace ht4c { namespace Hamster { namespace Db {
 			}
 		}
 
-		buf.ensure( key.row_len + 1 + key.column_qualifier_len + 1 + cell.value_len + 1 );
+		if( buf ) {
+			buf->ensure( key.row_len + 1 + key.column_qualifier_len + 1 + cell.value_len + 1 );
 
-		cell.row_key = key.row ? reinterpret_cast<const char*>( buf.add(key.row, key.row_len + 1) ) : 0;
-		cell.column_qualifier = key.column_qualifier ? reinterpret_cast<const char*>( buf.add(key.column_qualifier, key.column_qualifier_len + 1) ) : 0;
+			cell.row_key = key.row ? reinterpret_cast<const char*>( buf->add(key.row, key.row_len + 1) ) : 0;
+			cell.column_qualifier = key.column_qualifier ? reinterpret_cast<const char*>( buf->add(key.column_qualifier, key.column_qualifier_len + 1) ) : 0;
+		}
+		else {
+			cell.row_key = key.row;
+			cell.column_qualifier = key.column_qualifier;
+		}
 		cell.column_family = cf.get_name().c_str();
 		cell.timestamp = key.timestamp;
 		cell.revision = key.revision;
@@ -1216,8 +1703,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 		return true;
 	}
 
-	Scanner::ReaderScanAndFilter::ReaderScanAndFilter( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec )
-	: Reader(cursor, schema, scanSpec)
+	Scanner::ReaderScanAndFilter::ReaderScanAndFilter( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec )
+	: Reader(cursor, keyFormat, schema, scanSpec)
 	, nextRow( true )
 	, buf( HamsterEnv::KEYSIZE_DB )
 	{
@@ -1229,23 +1716,24 @@ namespace ht4c { namespace Hamster { namespace Db {
 		}
 
 		if( nextRow ) {
-			nextRow = false;
-
 			buf.clear();
-			Hypertable::create_key_and_append( buf
-				, Hypertable::FLAG_INSERT
+			HamsterKey::encode( keyFormat
+				, buf
 				, *scanContext->rowset.begin()
 				, 0
 				, 0
 				, Hypertable::TIMESTAMP_MAX
-				, Hypertable::AUTO_ASSIGN );
+				, Hypertable::AUTO_ASSIGN
+				, true );
 
 			k.set_size( buf.fill() );
 			k.set_data( (void*)buf.base );
+			cancelSeek( );
 			cursor->find( &k, 0, HAM_FIND_GEQ_MATCH );
+			nextRow = false;
 		}
 		else {
-			cursor->move_next( &k );
+			moveNextOrSeek( k );
 		}
 
 		return true;
@@ -1260,8 +1748,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 		return false;
 	}
 
-	Scanner::ReaderRowIntervals::ReaderRowIntervals( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec )
-	: Reader(cursor, schema, _scanSpec)
+	Scanner::ReaderRowIntervals::ReaderRowIntervals( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec )
+	: Reader(cursor, keyFormat, schema, _scanSpec)
 	, scanSpec( _scanSpec )
 	, it( _scanSpec.row_intervals.begin() )
 	, cmpStart( 0 )
@@ -1273,7 +1761,6 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 	bool Scanner::ReaderRowIntervals::moveNext( hamsterdb::key& k ) {
 		if( rowIntervalDone ) {
-			rowIntervalDone = false;
 			if( it == scanSpec.row_intervals.end() ) {
 				return false;
 			}
@@ -1285,21 +1772,24 @@ namespace ht4c { namespace Hamster { namespace Db {
 			cmpStart = it->start_inclusive ? 0 : 1;
 			cmpEnd = it->end_inclusive ? 0 : -1;
 			buf.clear();
-			Hypertable::create_key_and_append( buf
-				, Hypertable::FLAG_INSERT
+			HamsterKey::encode( keyFormat
+				, buf
 				, it->start
 				, 0
 				, 0
 				, Hypertable::TIMESTAMP_MAX
-				, Hypertable::AUTO_ASSIGN );
+				, Hypertable::AUTO_ASSIGN
+				, true );
 
 			k.set_size( buf.fill() );
 			k.set_data( (void*)buf.base );
+			cancelSeek( );
 			cursor->find( &k, 0, it->start_inclusive ? HAM_FIND_GEQ_MATCH : HAM_FIND_GT_MATCH );
+			rowIntervalDone = false;
 		}
 		else {
 			try {
-				cursor->move_next( &k );
+				moveNextOrSeek( k );
 			}
 			catch( hamsterdb::error& e ) {
 				if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
@@ -1330,8 +1820,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 		return false;
 	}
 
-	Scanner::ReaderCellIntervals::ReaderCellIntervals( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec )
-	: Reader(cursor, schema, _scanSpec)
+	Scanner::ReaderCellIntervals::ReaderCellIntervals( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec )
+	: Reader(cursor, keyFormat, schema, _scanSpec)
 	, scanSpec( _scanSpec )
 	, it( _scanSpec.cell_intervals.begin() )
 	, startColumnQualifier( 0 )
@@ -1343,16 +1833,10 @@ namespace ht4c { namespace Hamster { namespace Db {
 	, cellIntervalDone( true )
 	, buf( HamsterEnv::KEYSIZE_DB )
 	{
-		memset( timeOrderAsc, true, sizeof(timeOrderAsc) );
-		Hypertable::ColumnFamilySpecs& families = schema->get_column_families();
-		for each( Hypertable::ColumnFamilySpec* cf in families ) {
-			timeOrderAsc[cf->get_id()] = !cf->get_option_time_order_desc();
-		}
 	}
 
 	bool Scanner::ReaderCellIntervals::moveNext( hamsterdb::key& k ) {
 		if( cellIntervalDone ) {
-			cellIntervalDone = false;
 			if( it == scanSpec.cell_intervals.end() ) {
 				return false;
 			}
@@ -1393,8 +1877,8 @@ namespace ht4c { namespace Hamster { namespace Db {
 			endColumnQualifier = hasQualifier && !isRegexp ? endColumnQualifierBuf.c_str() : 0;
 
 			buf.clear();
-			Hypertable::create_key_and_append( buf
-				, Hypertable::FLAG_INSERT
+			HamsterKey::encode( keyFormat
+				, buf
 				, it->start_row
 				, startColumnFamilyCode
 				, startColumnQualifier
@@ -1404,11 +1888,13 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 			k.set_size( buf.fill() );
 			k.set_data( (void*)buf.base );
+			cancelSeek( );
 			cursor->find( &k, 0, it->start_inclusive ? HAM_FIND_GEQ_MATCH : HAM_FIND_GT_MATCH );
+			cellIntervalDone = false;
 		}
 		else {
 			try {
-				cursor->move_next( &k );
+				moveNextOrSeek( k );
 			}
 			catch( hamsterdb::error& e ) {
 				if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
@@ -1460,14 +1946,26 @@ namespace ht4c { namespace Hamster { namespace Db {
 		return 0;
 	}
 
-	ScannerAsync::ScannerAsync( Db::TablePtr _table )
-	: table( _table )
-	, db( _table->getDb() ) {
+	ScannerAsync::ScannerAsync( Db::TablePtr _table, const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags )
+	: Common::ScannerAsync( future )
+	, table( _table )
+	, scanner( _table->createScanner(scanSpec, flags) )
+	{
 	}
 
 	ScannerAsync::~ScannerAsync( ) {
-		db = 0;
+		scanner = 0;
 		table = 0;
 	}
 
+	bool ScannerAsync::read( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size ) {
+		HT4C_TRY {
+			// Hold the environment read lock for one batch only, so that
+			// mutators and other scanners can interleave
+			HamsterEnvReadLock sync( getEnv() );
+			return scanner->nextCells( cells, maxCells, maxBytes, size );
+		}
+		HT4C_HAMSTER_RETHROW
+	}
+
 } } }
\ No newline at end of file
@@ -27,6 +27,7 @@
 
 #include "ham/hamsterdb.hpp"
 #include "HamsterEnv.h"
+#include "ht4c.Common/Future.h"
 
 namespace ht4c { namespace Hamster { namespace Db {
 
@@ -51,6 +52,9 @@ namespace ht4c { namespace Hamster { namespace Db {
 	class ScannerAsync;
 	typedef boost::intrusive_ptr<ScannerAsync> ScannerAsyncPtr;
 
+	typedef Common::Future Future;
+	typedef Common::FuturePtr FuturePtr;
+
 	struct NamespaceListing {
 		std::string name;
 		bool isNamespace;
@@ -147,7 +151,9 @@ namespace ht4c { namespace Hamster { namespace Db {
 			}
 			void getTableSchema( bool withIds, std::string& schema );
 			Db::MutatorPtr createMutator( int32_t flags, int32_t flushInterval );
+			Db::MutatorAsyncPtr createMutatorAsync( Db::FuturePtr future, int32_t flags );
 			Db::ScannerPtr createScanner( const Hypertable::ScanSpec& scanSpec, uint32_t flags );
+			Db::ScannerAsyncPtr createScannerAsync( const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags );
 			Hypertable::SchemaPtr getSchema( );
 			bool nameExists( bool& isTable, uint16_t* id = 0 );
 			inline uint16_t getId( ) const {
@@ -156,6 +162,9 @@ namespace ht4c { namespace Hamster { namespace Db {
 			inline hamsterdb::db* getDb( ) const {
 				return db;
 			}
+			inline HamsterKeyFormat getKeyFormat( ) const {
+				return keyFormat;
+			}
 			void toKey( hamsterdb::key& key );
 			void toRecord( Hypertable::DynamicBuffer& buf, hamsterdb::record& record );
 			void fromRecord( hamsterdb::record& record );
@@ -174,6 +183,7 @@ namespace ht4c { namespace Hamster { namespace Db {
 			std::string keyName;
 			uint16_t id;
 			hamsterdb::db* db;
+			HamsterKeyFormat keyFormat;
 	};
 
 	class Mutator : public Hypertable::ReferenceCount {
@@ -190,9 +200,21 @@ namespace ht4c { namespace Hamster { namespace Db {
 			void set( const Hypertable::Cells& cells );
 			void del( Hypertable::KeySpec& keySpec );
 			void flush( );
+			inline bool isBatched( ) const {
+				return batched;
+			}
+			inline int32_t getFlushInterval( ) const {
+				return flushInterval;
+			}
+			void commit( );
+			void commitPending( );
 
 		private:
 
+			hamsterdb::txn* beginBatch( );
+			void endBatch( uint32_t size );
+			void checkBatch( );
+			void closeAppendCursor( );
 			void insert( Hypertable::Key& key, const void* value, uint32_t valueLength );
 			void set( Hypertable::Key& key, const void* value, uint32_t valueLength );
 			void del( Hypertable::Key& key );
@@ -239,30 +261,46 @@ namespace ht4c { namespace Hamster { namespace Db {
 			int32_t flushInterval;
 			Hypertable::DynamicBuffer buf;
 			hamsterdb::db* db;
+			HamsterKeyFormat keyFormat;
 			Hypertable::Schema* schema;
 			enum {
 				MAX_CF = 256
 			};
 			bool timeOrderAsc[MAX_CF];
+			bool batched;
+			hamsterdb::txn txn;
+			bool txnActive;
+			uint32_t batchCells;
+			uint32_t batchBytes;
+			ULONGLONG batchStart;
+			ham_status_t batchError;
+			bool sortedInput;
+			hamsterdb::cursor* appendCursor;
+			std::string lastColumnFamily;
+			uint8_t lastColumnFamilyCode;
 	};
 
-	class MutatorAsync : public Hypertable::ReferenceCount {
+	class MutatorAsync : public Common::MutatorAsync {
 
 		public:
 
-			explicit MutatorAsync( Db::TablePtr table );
+			MutatorAsync( Db::TablePtr table, Db::FuturePtr future, int32_t flags );
 			virtual ~MutatorAsync( );
 
 			inline HamsterEnv* getEnv( ) const {
 				return table->getEnv();
 			}
-			inline void flush( ) { }
+
+		protected:
+
+			virtual void write( const Hypertable::Cells& cells );
+			virtual void flushWritten( );
+			virtual void idle( );
 
 		private:
 
 			Db::TablePtr table;
-			hamsterdb::db* db;
-			Hypertable::Schema* schema;
+			Db::MutatorPtr mutator;
 	};
 
 	class Scanner : public Hypertable::ReferenceCount {
@@ -276,21 +314,58 @@ namespace ht4c { namespace Hamster { namespace Db {
 				return table->getEnv();
 			}
 			bool nextCell( Hypertable::Cell& cell );
+			bool nextCells( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size );
 
 		private:
 
+			enum {
+				PREFETCH_CELLS = 256
+			, PREFETCH_BYTES = 64 * 1024
+			};
+
+			void beginRead( );
+			void endRead( );
+
 			typedef Common::CellFilterInfo CellFilterInfo;
 			typedef Common::RegexpCache RegexpCache;
 			typedef Common::ScanContext ScanContext;
 
+			class KeyRange {
+
+				public:
+
+					explicit KeyRange( const Hypertable::ScanSpec& scanSpec );
+
+					inline bool hasStart( ) const {
+						return !prefix.empty();
+					}
+					inline const char* getStart( ) const {
+						return prefix.c_str();
+					}
+					inline bool hasEnd( ) const {
+						return !prefix.empty();
+					}
+					inline bool beyondEnd( const char* row ) const {
+						return strncmp( row, prefix.c_str(), prefix.size() ) > 0;
+					}
+
+				private:
+
+					static void literalPrefix( const char* regexp, std::string& prefix );
+
+					std::string prefix;
+			};
+
 			class Reader {
 
 				public:
 
-					Reader( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
+					Reader( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
 					virtual ~Reader();
 
-					bool nextCell( Hypertable::DynamicBuffer& buf, Hypertable::Key& key, Hypertable::Cell& cell );
+					bool nextCell( Hypertable::DynamicBuffer* buf, Hypertable::Key& key, Hypertable::Cell& cell );
+					void suspend( );
+					void resume( );
 
 				protected:
 
@@ -300,17 +375,35 @@ namespace ht4c { namespace Hamster { namespace Db {
 					virtual void limitReached( ) {
 						eos = true;
 					}
-					bool getCell( Hypertable::DynamicBuffer& buf, const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell );
+					bool getCell( Hypertable::DynamicBuffer* buf, const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell );
+					void moveNextOrSeek( hamsterdb::key& k );
+					void seek( const char* row, uint8_t columnFamilyCode, const char* columnQualifier, int64_t timestamp );
+					inline void cancelSeek( ) {
+						seekPending = false;
+						resumePending = false;
+					}
 
 					hamsterdb::cursor* cursor;
+					HamsterKeyFormat keyFormat;
 					ScanContext* scanContext;
 					int rowCount;
 					int cellCount;
 					int cellPerFamilyCount;
+					enum {
+						MAX_CF = 256
+					};
+					bool timeOrderAsc[MAX_CF];
 
 				private:
 
+					enum {
+						MAX_SEQUENTIAL_SKIPS = 8
+					};
+
 					bool checkCellLimits( const Hypertable::Key& key );
+					void seekTimeInterval( const Hypertable::Key& key );
+					void skipColumnFamily( const Hypertable::Key& key );
+					void skipColumnQualifier( const Hypertable::Key& key );
 
 					Hypertable::DynamicBuffer prevKey;
 					int prevColumnFamilyCode;
@@ -318,13 +411,22 @@ namespace ht4c { namespace Hamster { namespace Db {
 					int revsLimit;
 					int revsCount;
 					bool eos;
+					KeyRange keyRange;
+					bool started;
+					Hypertable::DynamicBuffer seekKey;
+					bool seekPending;
+					Hypertable::DynamicBuffer resumeKey;
+					bool resumeKeyValid;
+					bool resumePending;
+					uint8_t nextColumnFamilyCode[MAX_CF];
+					int skipCount;
 			};
 
 			class ReaderScanAndFilter : public Reader {
 
 				public:
 
-					ReaderScanAndFilter( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
+					ReaderScanAndFilter( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
 
 				protected:
 
@@ -341,7 +443,7 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 				public:
 
-					ReaderRowIntervals( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
+					ReaderRowIntervals( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
 
 				protected:
 
@@ -366,7 +468,7 @@ namespace ht4c { namespace Hamster { namespace Db {
 
 				public:
 
-					ReaderCellIntervals( hamsterdb::cursor* cursor, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
+					ReaderCellIntervals( hamsterdb::cursor* cursor, HamsterKeyFormat keyFormat, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec );
 
 				protected:
 
@@ -393,37 +495,42 @@ namespace ht4c { namespace Hamster { namespace Db {
 					int cmpStartRow;
 					int cmpEndRow;
 					bool cellIntervalDone;
-					enum {
-						MAX_CF = 256
-					};
-					bool timeOrderAsc[MAX_CF];
 					Hypertable::DynamicBuffer buf;
 			};
 
 			Db::TablePtr table;
 			int32_t flags;
 			hamsterdb::db* db;
+			bool transactions;
+			hamsterdb::txn txn;
+			bool txnActive;
 			hamsterdb::cursor cursor;
-			Hypertable::DynamicBuffer buf;
+			Hypertable::CellsBuilderPtr prefetch;
+			size_t prefetchIndex;
+			bool prefetchEos;
 			Reader* reader;
 			Hypertable::ScanSpecBuilder scanSpec;
 	};
 
-	class ScannerAsync : public Hypertable::ReferenceCount {
+	class ScannerAsync : public Common::ScannerAsync {
 
 		public:
 
-			explicit ScannerAsync( Db::TablePtr table );
+			ScannerAsync( Db::TablePtr table, const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags );
 			virtual ~ScannerAsync( );
 
 			inline HamsterEnv* getEnv( ) const {
 				return table->getEnv();
 			}
 
+		protected:
+
+			virtual bool read( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size );
+
 		private:
 
 			Db::TablePtr table;
-			hamsterdb::db* db;
+			Db::ScannerPtr scanner;
 	};
 
 } } }
@@ -27,6 +27,7 @@
 #include "HamsterEnv.h"
 #include "HamsterFactory.h"
 #include "HamsterClient.h"
+#include "HamsterCompactor.h"
 #include "HamsterException.h"
 
 namespace ht4c { namespace Hamster {
@@ -42,6 +43,11 @@ namespace ht4c { namespace Hamster {
 			, { 0, 0 }
 		};
 
+		static const ham_parameter_t binary_table_pars[] = {
+			  { HAM_PARAM_KEY_TYPE, HAM_TYPE_BINARY }
+			, { 0, 0 }
+		};
+
 		static const uint32_t dbCreateFlags		= 0;
 		static const uint32_t dbOpenFlags			= 0;
 
@@ -78,20 +84,29 @@ namespace ht4c { namespace Hamster {
 	HamsterEnv::HamsterEnv( const std::string &filename, const HamsterEnvConfig& config )
 	: env( new hamsterdb::env() )
 	, sysdb( 0 )
+	, keyFormat( config.binaryKeys || config.migrateKeys ? KF_Binary : KF_Serialized )
+	, transactions( config.enableTransactions )
+	, txnMaxCells( std::max(1, config.txnMaxCells) )
+	, txnMaxBytes( std::max(1, config.txnMaxSizeKB) * 1024 )
+	, txnMaxAge( std::max(1, config.txnMaxAgeMsec) )
+	, compactor( 0 )
 	{
 		const uint32_t envFlags =		(config.enableRecovery ? HAM_ENABLE_RECOVERY : 0)
-															| (config.enableAutoRecovery ? HAM_ENABLE_RECOVERY|HAM_AUTO_RECOVERY : 0);
+															| (config.enableAutoRecovery ? HAM_ENABLE_RECOVERY|HAM_AUTO_RECOVERY : 0)
+															| (config.enableTransactions ? HAM_ENABLE_TRANSACTIONS : 0);
 
-		::InitializeCriticalSection( &cs );
+		::InitializeSRWLock( &srw );
 		try {
 			ham_set_errhandler( errhandler );
 
 			const ham_parameter_t env_pars[] = {
 					{ HAM_PARAM_CACHESIZE, std::max(1, config.cacheSizeMB) * 1024 * 1024 }
+				, { HAM_PARAM_CACHE_POLICY, config.cacheScanResistant ? HAM_CACHE_POLICY_2Q : HAM_CACHE_POLICY_LRU }
+				, { HAM_PARAM_CACHE_DIRTY_LIMIT, std::max(0, config.cacheDirtyPageLimit) }
 				, { 0, 0 }
 			};
 
-			env->open( filename.c_str(), envFlags );
+			env->open( filename.c_str(), envFlags, env_pars );
 		}
 		catch( hamsterdb::error& e ) {
 			if( e.get_errno() != HAM_FILE_NOT_FOUND ) {
@@ -101,6 +116,8 @@ namespace ht4c { namespace Hamster {
 			const ham_parameter_t env_pars[] = {
 					{ HAM_PARAM_CACHESIZE, std::max(1, config.cacheSizeMB) * 1024 * 1024 }
 				, { HAM_PARAM_PAGESIZE, (std::min(64, config.pageSizeKB) / 64) * 64 * 1024 }
+				, { HAM_PARAM_CACHE_POLICY, config.cacheScanResistant ? HAM_CACHE_POLICY_2Q : HAM_CACHE_POLICY_LRU }
+				, { HAM_PARAM_CACHE_DIRTY_LIMIT, std::max(0, config.cacheDirtyPageLimit) }
 				, { 0, 0 }
 			};
 
@@ -116,10 +133,21 @@ namespace ht4c { namespace Hamster {
 			}
 			sysdb = From( env->create_db(SYS_DB, dbCreateFlags, sys_pars) );
 		}
+
+		if( config.migrateKeys ) {
+			migrateTables();
+		}
+
+		if( config.compactionIntervalSec > 0 ) {
+			compactor = new HamsterCompactor( this, config.compactionIntervalSec, config.compactionMaxCells );
+		}
 	}
 
 	HamsterEnv::~HamsterEnv( ) {
-		::DeleteCriticalSection( &cs );
+		if( compactor ) {
+			delete compactor;
+			compactor = 0;
+		}
 		HT4C_TRY {
 			for( tables_t::iterator it = tables.begin(); it != tables.end(); ++it ) {
 				for each( Db::Table* table in (*it).second.ref ) {
@@ -149,16 +177,25 @@ namespace ht4c { namespace Hamster {
 		}
 	}
 
+	HamsterKeyFormat HamsterEnv::getKeyFormat( hamsterdb::db* db ) {
+		ham_parameter_t pars[] = {
+			  { HAM_PARAM_KEY_TYPE, 0 }
+			, { 0, 0 }
+		};
+
+		db->get_parameters( pars );
+		return pars[0].value == HAM_TYPE_CUSTOM ? KF_Serialized : KF_Binary;
+	}
+
 	uint16_t HamsterEnv::createTable( ) {
-		std::vector<ham_u16_t> names = env->get_database_names();
-		std::set<uint16_t> ids( names.begin(), names.end() );
-		uint16_t id = FIRST_TABLE_DB;
-		while( ids.find(id) != ids.end() ) {
-			++id;
+		uint16_t id = nextTableId();
+		if( keyFormat == KF_Binary ) {
+			env->create_db( id, dbCreateFlags, binary_table_pars );
+		}
+		else {
+			hamsterdb::db db = env->create_db( id, dbCreateFlags, table_pars );
+			db.set_compare_func( KeyCompare );
 		}
-		
-		hamsterdb::db db = env->create_db( id, dbCreateFlags, table_pars );
-		db.set_compare_func( KeyCompare );
 		return id;
 	}
 
@@ -166,8 +203,7 @@ namespace ht4c { namespace Hamster {
 		tables_t::iterator it = tables.find( id );
 		if( it == tables.end() ) {
 			db_t db;
-			db.db = From( env->open_db(id, dbOpenFlags) );
-			db.db->set_compare_func( KeyCompare );
+			db.db = openTableDb( id );
 			db.ref.insert( table );
 			it = tables.insert(std::make_pair(id, db)).first;
 		}
@@ -177,6 +213,19 @@ namespace ht4c { namespace Hamster {
 		return (*it).second.db;
 	}
 
+	hamsterdb::db* HamsterEnv::findTableDb( uint16_t id ) const {
+		tables_t::const_iterator it = tables.find( id );
+		return it != tables.end() ? (*it).second.db : 0;
+	}
+
+	hamsterdb::db* HamsterEnv::openTableDb( uint16_t id ) {
+		hamsterdb::db* db = From( env->open_db(id, dbOpenFlags) );
+		if( getKeyFormat(db) == KF_Serialized ) {
+			db->set_compare_func( KeyCompare );
+		}
+		return db;
+	}
+
 	void HamsterEnv::disposeTable( uint16_t id, Db::Table* table ) {
 		tables_t::iterator it = tables.find( id );
 		if( it != tables.end() ) {
@@ -215,4 +264,123 @@ namespace ht4c { namespace Hamster {
 		env->erase_db( id );
 	}
 
+	void HamsterEnv::attachBatch( Db::Mutator* mutator ) {
+		batches.insert( mutator );
+	}
+
+	void HamsterEnv::detachBatch( Db::Mutator* mutator ) {
+		batches.erase( mutator );
+	}
+
+	void HamsterEnv::commitBatches( bool shared ) {
+		// SRW locks cannot be upgraded, the shared lock is released meanwhile
+		if( shared ) {
+			unlockShared();
+			lock();
+		}
+		std::set<Db::Mutator*> b( batches ); // shallow copy, commit detaches the mutator
+		for each( Db::Mutator* mutator in b ) {
+			mutator->commitPending();
+		}
+		if( shared ) {
+			unlock();
+			lockShared();
+		}
+	}
+
+	uint16_t HamsterEnv::nextTableId( ) {
+		std::vector<ham_u16_t> names = env->get_database_names();
+		std::set<uint16_t> ids( names.begin(), names.end() );
+		uint16_t id = FIRST_TABLE_DB;
+		while( ids.find(id) != ids.end() ) {
+			++id;
+		}
+		return id;
+	}
+
+	void HamsterEnv::migrateTables( ) {
+		// collect the table records first, the sys db will be updated while migrating
+		typedef std::vector<std::pair<std::string, std::string> > records_t;
+		records_t records;
+		{
+			hamsterdb::key key;
+			hamsterdb::record record;
+			hamsterdb::cursor cursor( sysdb );
+			try {
+				while( true ) {
+					cursor.move_next( &key, &record );
+					if( record.get_size() > sizeof(uint16_t) ) { // namespaces do not have a record
+						records.push_back( std::make_pair(
+								std::string(reinterpret_cast<const char*>(key.get_data()), key.get_size())
+							, std::string(reinterpret_cast<const char*>(record.get_data()), record.get_size())) );
+					}
+				}
+			}
+			catch( hamsterdb::error& e ) {
+				if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
+					throw;
+				}
+			}
+		}
+
+		for( records_t::iterator it = records.begin(); it != records.end(); ++it ) {
+			uint16_t id = *reinterpret_cast<const uint16_t*>( (*it).second.data() );
+			uint16_t migratedId = migrateTable( id );
+			if( migratedId != id ) {
+				// switch the table to the migrated db before dropping the existing one
+				memcpy( &(*it).second[0], &migratedId, sizeof(uint16_t) );
+				hamsterdb::key key( &(*it).first[0], static_cast<ham_u16_t>((*it).first.size()) );
+				hamsterdb::record record( &(*it).second[0], static_cast<ham_u32_t>((*it).second.size()) );
+				sysdb->insert( &key, &record, HAM_OVERWRITE );
+				env->erase_db( id );
+			}
+		}
+	}
+
+	uint16_t HamsterEnv::migrateTable( uint16_t id ) {
+		hamsterdb::db db = env->open_db( id, dbOpenFlags );
+		if( getKeyFormat(&db) != KF_Serialized ) {
+			return id;
+		}
+		db.set_compare_func( KeyCompare );
+
+		uint16_t migratedId = nextTableId();
+		hamsterdb::db migratedDb = env->create_db( migratedId, dbCreateFlags, binary_table_pars );
+
+		Hypertable::DynamicBuffer buf( KEYSIZE_DB );
+		hamsterdb::key k;
+		hamsterdb::record r;
+		hamsterdb::cursor cursor( &db );
+		try {
+			while( true ) {
+				cursor.move_next( &k, &r );
+
+				Hypertable::Key key;
+				if( !HamsterKey::decode(KF_Serialized, k, 0, key) ) {
+					HT4C_HAMSTER_THROW( Hypertable::Error::BAD_KEY, Hypertable::format("Cannot load key while migrating table %d", id).c_str() );
+				}
+
+				buf.clear();
+				HamsterKey::encode( KF_Binary
+					, buf
+					, key.row
+					, key.column_family_code
+					, key.column_qualifier
+					, key.timestamp
+					, key.revision
+					, (key.control & Hypertable::Key::TS_CHRONOLOGICAL) == 0 );
+
+				hamsterdb::key migratedKey( buf.base, static_cast<ham_u16_t>(buf.fill()) );
+				migratedDb.insert( &migratedKey, &r, HAM_OVERWRITE );
+			}
+		}
+		catch( hamsterdb::error& e ) {
+			if( e.get_errno() != HAM_KEY_NOT_FOUND ) {
+				throw;
+			}
+		}
+
+		return migratedId;
+	}
+
 } }
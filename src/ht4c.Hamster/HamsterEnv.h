@@ -25,6 +25,8 @@
 #error compile native
 #endif
 
+#include "HamsterKey.h"
+
 namespace hamsterdb {
 	class env;
 	class db;
@@ -41,10 +43,12 @@ namespace ht4c { namespace Hamster {
 	namespace Db {
 
 		class Table;
+		class Mutator;
 
 	}
 
 	struct HamsterEnvConfig;
+	class HamsterCompactor;
 
 	/// <summary>
 	/// Represents the Hypertable hamster environment.
@@ -69,11 +73,40 @@ namespace ht4c { namespace Hamster {
 				return sysdb;
 			}
 			void flush( ) const;
+			inline HamsterKeyFormat getKeyFormat( ) const {
+				return keyFormat;
+			}
+			static HamsterKeyFormat getKeyFormat( hamsterdb::db* db );
+			inline bool hasTransactions( ) const {
+				return transactions;
+			}
+			inline uint32_t getTxnMaxCells( ) const {
+				return txnMaxCells;
+			}
+			inline uint32_t getTxnMaxBytes( ) const {
+				return txnMaxBytes;
+			}
+			inline uint32_t getTxnMaxAge( ) const {
+				return txnMaxAge;
+			}
+			inline const HamsterCompactor* getCompactor( ) const {
+				return compactor;
+			}
 			uint16_t createTable( );
 			hamsterdb::db* openTable( uint16_t id, Db::Table* table );
+			hamsterdb::db* findTableDb( uint16_t id ) const;
+			hamsterdb::db* openTableDb( uint16_t id );
 			void disposeTable( uint16_t id, Db::Table* table );
 			void refreshTable( uint16_t id );
 			void eraseTable( uint16_t id );
+			void attachBatch( Db::Mutator* mutator );
+			void detachBatch( Db::Mutator* mutator );
+
+			/// <summary>
+			/// Commits the open batches of all mutators, requires the exclusive lock or,
+			/// if shared is true, the shared lock which gets upgraded for the call.
+			/// </summary>
+			void commitBatches( bool shared );
 
 			class Lock {
 
@@ -93,6 +126,40 @@ namespace ht4c { namespace Hamster {
 			};
 			friend class Lock;
 
+			/// <summary>
+			/// Lock for scanner reads, shared if the scanners read in private transactions,
+			/// otherwise exclusive because hamster returns keys and records in a per-database buffer.
+			/// </summary>
+			class ReadLock {
+
+				public:
+
+					inline ReadLock( HamsterEnv* _env )
+					: env( _env )
+					, shared( _env->hasTransactions() ) {
+						if( shared ) {
+							env->lockShared();
+						}
+						else {
+							env->lock();
+						}
+					}
+					inline ~ReadLock( ) {
+						if( shared ) {
+							env->unlockShared();
+						}
+						else {
+							env->unlock();
+						}
+					}
+
+				private:
+
+					HamsterEnv* env;
+					bool shared;
+			};
+			friend class ReadLock;
+
 		private:
 
 			enum {
@@ -112,22 +179,40 @@ namespace ht4c { namespace Hamster {
 				void dispose( );
 			};
 
+			uint16_t nextTableId( );
+			void migrateTables( );
+			uint16_t migrateTable( uint16_t id );
+
 			inline void lock( ) {
-				::EnterCriticalSection( &cs );
+				::AcquireSRWLockExclusive( &srw );
 			}
 			inline void unlock( ) {
-				::LeaveCriticalSection( &cs );
+				::ReleaseSRWLockExclusive( &srw );
+			}
+			inline void lockShared( ) {
+				::AcquireSRWLockShared( &srw );
+			}
+			inline void unlockShared( ) {
+				::ReleaseSRWLockShared( &srw );
 			}
 
 			hamsterdb::env* env;
 			hamsterdb::db* sysdb;
+			HamsterKeyFormat keyFormat;
+			bool transactions;
+			uint32_t txnMaxCells;
+			uint32_t txnMaxBytes;
+			uint32_t txnMaxAge;
 			typedef std::unordered_map<uint16_t, db_t> tables_t;
 			tables_t tables;
+			std::set<Db::Mutator*> batches;
+			HamsterCompactor* compactor;
 
-			CRITICAL_SECTION cs;
+			SRWLOCK srw;
 	};
 	typedef boost::intrusive_ptr<HamsterEnv> HamsterEnvPtr;
 
 	typedef HamsterEnv::Lock HamsterEnvLock;
+	typedef HamsterEnv::ReadLock HamsterEnvReadLock;
 
 } }
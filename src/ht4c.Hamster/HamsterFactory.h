@@ -39,12 +39,32 @@ namespace ht4c { namespace Hamster {
 		bool enableAutoRecovery;
 		int cacheSizeMB;
 		int pageSizeKB;
+		bool cacheScanResistant;
+		int cacheDirtyPageLimit;
+		bool binaryKeys;
+		bool migrateKeys;
+		bool enableTransactions;
+		int txnMaxCells;
+		int txnMaxSizeKB;
+		int txnMaxAgeMsec;
+		int compactionIntervalSec;
+		int compactionMaxCells;
 
 		HamsterEnvConfig( )
 			: enableRecovery( false )
 			, enableAutoRecovery( false )
 			, cacheSizeMB( 64 )
 			, pageSizeKB( 64 )
+			, cacheScanResistant( false )
+			, cacheDirtyPageLimit( 0 )
+			, binaryKeys( false )
+			, migrateKeys( false )
+			, enableTransactions( false )
+			, txnMaxCells( 10000 )
+			, txnMaxSizeKB( 4096 )
+			, txnMaxAgeMsec( 1000 )
+			, compactionIntervalSec( 0 )
+			, compactionMaxCells( 10000 )
 		{
 		}
 	};
@@ -0,0 +1,157 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+#include "stdafx.h"
+#include "HamsterKey.h"
+
+namespace ht4c { namespace Hamster {
+
+	void HamsterKey::encode( HamsterKeyFormat keyFormat
+												 , Hypertable::DynamicBuffer& buf
+												 , const char* row
+												 , uint8_t columnFamilyCode
+												 , const char* columnQualifier
+												 , int64_t timestamp
+												 , int64_t revision
+												 , bool timeOrderAsc )
+	{
+		if( keyFormat == KF_Serialized ) {
+			Hypertable::create_key_and_append( buf
+				, Hypertable::FLAG_INSERT // always flag INSERT stored
+				, row
+				, columnFamilyCode
+				, columnQualifier
+				, timestamp
+				, revision
+				, timeOrderAsc );
+
+			return;
+		}
+
+		if( !row ) {
+			row = "";
+		}
+		if( !columnQualifier ) {
+			columnQualifier = "";
+		}
+
+		size_t rowLength = strlen( row ) + 1;
+		size_t columnQualifierLength = strlen( columnQualifier ) + 1;
+		bool hasRevision = revision != Hypertable::AUTO_ASSIGN;
+
+		buf.ensure( rowLength + 1 + columnQualifierLength + 1 + (hasRevision ? 16 : 8) );
+		buf.add_unchecked( row, rowLength );
+		*buf.ptr++ = columnFamilyCode;
+		buf.add_unchecked( columnQualifier, columnQualifierLength );
+		*buf.ptr++ = Hypertable::FLAG_INSERT; // always flag INSERT stored
+		encodeBinary( buf.ptr, timestamp, timeOrderAsc );
+		if( hasRevision ) {
+			encodeBinary( buf.ptr, revision, true );
+		}
+	}
+
+	const char* HamsterKey::row( HamsterKeyFormat keyFormat, const hamsterdb::key& k ) {
+		if( keyFormat == KF_Serialized ) {
+			return Hypertable::SerializedKey( reinterpret_cast<const uint8_t*>(k.get_data()) ).row();
+		}
+
+		return reinterpret_cast<const char*>( k.get_data() );
+	}
+
+	bool HamsterKey::decode( HamsterKeyFormat keyFormat, const hamsterdb::key& k, const bool* timeOrderAsc, Hypertable::Key& key ) {
+		if( keyFormat == KF_Serialized ) {
+			return key.load( Hypertable::SerializedKey(reinterpret_cast<const uint8_t*>(k.get_data())) );
+		}
+
+		const uint8_t* base = reinterpret_cast<const uint8_t*>( k.get_data() );
+		const uint8_t* end = base + k.get_size();
+
+		// row
+		const uint8_t* ptr = reinterpret_cast<const uint8_t*>( memchr(base, 0, end - base) );
+		if( !ptr || end - ptr < 2 ) {
+			return false;
+		}
+		key.row = reinterpret_cast<const char*>( base );
+		key.row_len = static_cast<uint32_t>( ptr - base );
+		++ptr;
+
+		// column family, column qualifier
+		key.column_family_code = *ptr++;
+		const uint8_t* columnQualifier = ptr;
+		ptr = reinterpret_cast<const uint8_t*>( memchr(columnQualifier, 0, end - columnQualifier) );
+		if( !ptr ) {
+			return false;
+		}
+		key.column_qualifier = reinterpret_cast<const char*>( columnQualifier );
+		key.column_qualifier_len = static_cast<uint32_t>( ptr - columnQualifier );
+		++ptr;
+
+		// flag, timestamp [, revision]
+		ptrdiff_t remaining = end - ptr;
+		if( remaining != 1 + 8 && remaining != 1 + 16 ) {
+			return false;
+		}
+		key.flag_ptr = ptr;
+		key.flag = *ptr++;
+
+		bool asc = timeOrderAsc[key.column_family_code];
+		key.control = Hypertable::Key::HAVE_TIMESTAMP | (asc ? 0 : Hypertable::Key::TS_CHRONOLOGICAL);
+		key.timestamp = decodeBinary( ptr, asc );
+		if( remaining == 1 + 16 ) {
+			key.control |= Hypertable::Key::HAVE_REVISION;
+			key.revision = decodeBinary( ptr, true );
+		}
+		else {
+			key.revision = Hypertable::AUTO_ASSIGN;
+		}
+		key.length = k.get_size();
+
+		return true;
+	}
+
+	void HamsterKey::encodeBinary( uint8_t*& ptr, int64_t value, bool invert ) {
+		// flip the sign bit, signed values compare like unsigned values
+		uint64_t v = static_cast<uint64_t>( value ) ^ 0x8000000000000000ULL;
+		if( invert ) {
+			v = ~v;
+		}
+		for( int shift = 56; shift >= 0; shift -= 8 ) {
+			*ptr++ = static_cast<uint8_t>( v >> shift );
+		}
+	}
+
+	int64_t HamsterKey::decodeBinary( const uint8_t*& ptr, bool invert ) {
+		uint64_t v = 0;
+		for( int i = 0; i < 8; ++i ) {
+			v = (v << 8) | *ptr++;
+		}
+		if( invert ) {
+			v = ~v;
+		}
+		return static_cast<int64_t>( v ^ 0x8000000000000000ULL );
+	}
+
+} }
@@ -0,0 +1,78 @@
+/** -*- C++ -*-
+ * Copyright (C) 2010-2016 Thalmann Software & Consulting, http://www.softdev.ch
+ *
+ * This file is part of ht4c.
+ *
+ * ht4c is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#pragma once
+
+#ifdef __cplusplus_cli
+#error compile native
+#endif
+
+namespace hamsterdb {
+	class key;
+}
+
+namespace Hypertable {
+	class DynamicBuffer;
+	class Key;
+}
+
+namespace ht4c { namespace Hamster {
+
+	/// <summary>
+	/// Specifies possible hamster table key formats.
+	/// </summary>
+	enum HamsterKeyFormat {
+		KF_Serialized = 0 // Hypertable serialized keys, requires the custom key compare function
+	, KF_Binary     = 1 // Byte order equals the Hypertable key order, uses the built-in memcmp compare
+	};
+
+	/// <summary>
+	/// Encodes and decodes the hamster table keys.
+	/// </summary>
+	/// <remarks>
+	/// A binary key is laid out as row\0, column family code, column qualifier\0, flag,
+	/// timestamp and optional revision, both big endian with the sign bit flipped. The
+	/// timestamp is inverted unless the column family has been declared as time order desc,
+	/// the revision is always inverted so that the newest revision sorts first.
+	/// </remarks>
+	class HamsterKey {
+
+		public:
+
+			static void encode( HamsterKeyFormat keyFormat
+												, Hypertable::DynamicBuffer& buf
+												, const char* row
+												, uint8_t columnFamilyCode
+												, const char* columnQualifier
+												, int64_t timestamp
+												, int64_t revision
+												, bool timeOrderAsc );
+
+			static const char* row( HamsterKeyFormat keyFormat, const hamsterdb::key& k );
+			static bool decode( HamsterKeyFormat keyFormat, const hamsterdb::key& k, const bool* timeOrderAsc, Hypertable::Key& key );
+
+		private:
+
+			static void encodeBinary( uint8_t*& ptr, int64_t value, bool invert );
+			static int64_t decodeBinary( const uint8_t*& ptr, bool invert );
+	};
+
+} }
@@ -65,15 +65,20 @@ namespace ht4c { namespace Hamster {
 	}
 
 	Common::AsyncTableMutator* HamsterTable::createAsyncMutator( Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t flags ) {
-		/*HT4C_TRY {
-			HamsterEnvLock sync( table->getEnv() );
-			TODO Hypertable::HamsterGen::Future future = typeid(asyncResult) != typeid(HamsterBlockingAsyncResult)
-																					 ? static_cast<HamsterAsyncResult&>(asyncResult).get(env)
-																					 : static_cast<HamsterBlockingAsyncResult&>(asyncResult).get(env);
-			return HamsterAsyncTableMutator::create( table->async_createMutator(future, flags) );
+		HT4C_TRY {
+			Db::FuturePtr future = typeid(asyncResult) != typeid(HamsterBlockingAsyncResult)
+													 ? static_cast<HamsterAsyncResult&>(asyncResult).get(table->getEnv())
+													 : static_cast<HamsterBlockingAsyncResult&>(asyncResult).get(table->getEnv());
+
+			Db::MutatorAsyncPtr tableMutator;
+			{
+				HamsterEnvLock sync( table->getEnv() );
+				tableMutator = table->createMutatorAsync( future, flags );
+			}
+			asyncResult.attachAsyncMutator( HamsterAsyncTableMutator::id(tableMutator) );
+			return HamsterAsyncTableMutator::create( tableMutator );
 		}
-		HT4C_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	Common::TableScanner* HamsterTable::createScanner( Common::ScanSpec& scanSpec, uint32_t /*timeoutMsec*/, uint32_t flags ) {
@@ -84,34 +89,19 @@ namespace ht4c { namespace Hamster {
 		HT4C_HAMSTER_RETHROW
 	}
 
-	Common::AsyncTableScanner* HamsterTable::createAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t /*flags*/ ) {
-		/*HT4C_TRY {
-			Hypertable::HamsterGen::ScanSpec _scanSpec;
-			convertScanSpec( scanSpec, _scanSpec );
-			HamsterEnvLock sync( table->getEnv() );
-			Hypertable::HamsterGen::Future future = typeid(asyncResult) != typeid(HamsterBlockingAsyncResult)
-																					 ? static_cast<HamsterAsyncResult&>(asyncResult).get(env)
-																					 : static_cast<HamsterBlockingAsyncResult&>(asyncResult).get(env);
-
-			return HamsterAsyncTableScanner::create( table->async_createScanner(future, _scanSpec) );
+	Common::AsyncTableScanner* HamsterTable::createAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t flags ) {
+		HT4C_TRY {
+			return HamsterAsyncTableScanner::create( startAsyncScanner(scanSpec, asyncResult, flags) );
 		}
-		HT4C_HAMSTER_RETHROW */
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
-	int64_t HamsterTable::createAsyncScannerId( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t /*flags*/ ) {
-		/*HT4C_TRY {
-			Hypertable::HamsterGen::ScanSpec _scanSpec;
-			convertScanSpec( scanSpec, _scanSpec );
-			HamsterEnvLock sync( table->getEnv() );
-			Hypertable::HamsterGen::Future future = typeid(asyncResult) != typeid(HamsterBlockingAsyncResult)
-																					 ? static_cast<HamsterAsyncResult&>(asyncResult).get(env)
-																					 : static_cast<HamsterBlockingAsyncResult&>(asyncResult).get(env);
-
-			return HamsterAsyncTableScanner::id( env->async_createScanner(ns, name, future, _scanSpec) );
+	int64_t HamsterTable::createAsyncScannerId( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t flags ) {
+		HT4C_TRY {
+			// the worker holds a reference to the scanner until the scan has been completed or cancelled
+			return HamsterAsyncTableScanner::id( startAsyncScanner(scanSpec, asyncResult, flags) );
 		}
-		HT4C_HAMSTER_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_HAMSTER_RETHROW
 	}
 
 	std::string HamsterTable::getSchema( bool withIds ) {
@@ -124,6 +114,29 @@ namespace ht4c { namespace Hamster {
 		HT4C_HAMSTER_RETHROW
 	}
 
+	Db::ScannerAsyncPtr HamsterTable::startAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t flags ) {
+		Db::FuturePtr future = typeid(asyncResult) != typeid(HamsterBlockingAsyncResult)
+												 ? static_cast<HamsterAsyncResult&>(asyncResult).get(table->getEnv())
+												 : static_cast<HamsterBlockingAsyncResult&>(asyncResult).get(table->getEnv());
+
+		Db::ScannerAsyncPtr tableScanner;
+		{
+			HamsterEnvLock sync( table->getEnv() );
+			tableScanner = table->createScannerAsync( scanSpec.get(), future, flags );
+		}
+
+		// attach before the first results get published
+		asyncResult.attachAsyncScanner( HamsterAsyncTableScanner::id(tableScanner) );
+		try {
+			tableScanner->start();
+		}
+		catch( ... ) {
+			asyncResult.cancelAsyncScanner( HamsterAsyncTableScanner::id(tableScanner) );
+			throw;
+		}
+		return tableScanner;
+	}
+
 	HamsterTable::HamsterTable( Db::TablePtr _table )
 	: table( _table )
 	{
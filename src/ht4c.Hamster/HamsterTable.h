@@ -83,6 +83,8 @@ namespace ht4c { namespace Hamster {
 			HamsterTable( const HamsterTable& ) { }
 			HamsterTable& operator = ( const HamsterTable& ) { return *this; }
 
+			Db::ScannerAsyncPtr startAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t flags );
+
 			Db::TablePtr table;
 	};
 
@@ -41,6 +41,10 @@ namespace ht4c { namespace Hamster {
 
 	HamsterTableMutator::~HamsterTableMutator( ) {
 		HT4C_TRY {
+			if( timer ) {
+				::DeleteTimerQueueTimer( 0, timer, INVALID_HANDLE_VALUE );
+				timer = 0;
+			}
 			{
 				HamsterEnvLock sync( tableMutator->getEnv() );
 				tableMutator->flush( );
@@ -98,7 +102,25 @@ namespace ht4c { namespace Hamster {
 
 	HamsterTableMutator::HamsterTableMutator( Db::MutatorPtr _tableMutator )
 	:tableMutator( _tableMutator )
+	, timer( 0 )
 	{
+		// Commit pending cells of a batched mutator periodically, an idle batch
+		// must not outlive TxnMaxAgeMsec even without a flush interval
+		if( tableMutator->isBatched() ) {
+			DWORD interval = tableMutator->getEnv()->getTxnMaxAge();
+			if( tableMutator->getFlushInterval() > 0 ) {
+				interval = std::min( interval, static_cast<DWORD>(tableMutator->getFlushInterval()) );
+			}
+			if( !::CreateTimerQueueTimer(&timer, 0, timerProc, this, interval, interval, WT_EXECUTEDEFAULT) ) {
+				timer = 0;
+			}
+		}
+	}
+
+	VOID HamsterTableMutator::timerProc( void* param, BOOLEAN /*timerOrWaitFired*/ ) {
+		HamsterTableMutator* mutator = reinterpret_cast<HamsterTableMutator*>( param );
+		HamsterEnvLock sync( mutator->tableMutator->getEnv() );
+		mutator->tableMutator->commitPending( );
 	}
 	
 } }
\ No newline at end of file
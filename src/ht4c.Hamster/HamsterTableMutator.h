@@ -71,7 +71,10 @@ namespace ht4c { namespace Hamster {
 			HamsterTableMutator( const HamsterTableMutator& ) { }
 			HamsterTableMutator& operator = ( const HamsterTableMutator& ) { return *this; }
 
+			static VOID CALLBACK timerProc( void* param, BOOLEAN timerOrWaitFired );
+
 			Db::MutatorPtr tableMutator;
+			HANDLE timer;
 	};
 
 } }
\ No newline at end of file
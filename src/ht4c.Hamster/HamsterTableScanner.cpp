@@ -43,7 +43,7 @@ namespace ht4c { namespace Hamster {
 
 	bool HamsterTableScanner::next( Common::Cell*& _cell ) {
 		HT4C_TRY {
-			HamsterEnvLock sync( tableScanner->getEnv() );
+			HamsterEnvReadLock sync( tableScanner->getEnv() );
 			if( tableScanner->nextCell(cell.get()) ) {
 				_cell = &cell;
 				return true;
@@ -54,6 +54,19 @@ namespace ht4c { namespace Hamster {
 		HT4C_HAMSTER_RETHROW
 	}
 
+	bool HamsterTableScanner::nextCells( Common::Cells& cells, uint32_t maxCells, uint32_t maxBytes ) {
+		HT4C_TRY {
+			size_t count = cells.size();
+			uint32_t size;
+			{
+				HamsterEnvReadLock sync( tableScanner->getEnv() );
+				tableScanner->nextCells( cells.builder(), maxCells, maxBytes, size );
+			}
+			return cells.size() > count;
+		}
+		HT4C_HAMSTER_RETHROW
+	}
+
 	HamsterTableScanner::HamsterTableScanner( Db::ScannerPtr _tableScanner )
 	: tableScanner( _tableScanner )
 	{
@@ -28,6 +28,7 @@
 #include "HamsterClient.h"
 #include "ht4c.Common/Types.h"
 #include "ht4c.Common/Cell.h"
+#include "ht4c.Common/Cells.h"
 #include "ht4c.Common/TableScanner.h"
 
 namespace Hypertable {
@@ -60,6 +61,7 @@ namespace ht4c { namespace Hamster {
 			#pragma region Common::TableScanner methods
 
 			virtual bool next( Common::Cell*& cell );
+			virtual bool nextCells( Common::Cells& cells, uint32_t maxCells, uint32_t maxBytes );
 
 			#pragma endregion
 
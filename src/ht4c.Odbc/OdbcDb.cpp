@@ -653,13 +653,16 @@ namespace ht4c { namespace Odbc { namespace Db {
 	: table( _table )
 	, flags( _flags )
 	, flushInterval( _flushInterval )
-	, db( 0 )
+	, db( _table->getEnv()->acquireDb() )
 	, os( 0 )
 	, os_sm( 0 )
 	, os_del_row( 0 )
 	, os_del_cf( 0 )
 	, os_del_cell( 0 )
 	, os_del_cell_version( 0 )
+	, os_stage( 0 )
+	, bulkInsertRows( _table->getEnv()->getBulkInsertRows() )
+	, staged( 0 )
 	, env( _table->getEnv() )
 	, schema( _table->getSchema().get() )
 	{
@@ -669,8 +672,27 @@ namespace ht4c { namespace Odbc { namespace Db {
 			timeOrderAsc[cf->get_id()] = !cf->get_option_time_order_desc();
 		}
 
-		OdbcStm stm( table.get() );
-		os = newOdbcStream( 16, stm.insert(), getDb() );
+		try {
+			OdbcStm stm( table.get() );
+			if( bulkInsertRows > 0 ) {
+				// array bound inserts into a temp table, merged set-based into the table
+				staging = Hypertable::format( "#%s_%p", table->getId(), this );
+				odbc::otl_cursor::direct_exec( *getDb(), stm.createStaging(staging).c_str(), odbc::otl_exception::enabled );
+				os_stage = newOdbcStream( bulkInsertRows, stm.insertStaging(staging), getDb() );
+			}
+			else {
+				os = newOdbcStream( 16, stm.insert(), getDb() );
+			}
+		}
+		catch( ... ) {
+			if( os_stage ) {
+				delete os_stage;
+				os_stage = 0;
+			}
+			env->releaseDb( db );
+			db = 0;
+			throw;
+		}
 	}
 
 	Mutator::~Mutator( ) {
@@ -686,10 +708,23 @@ namespace ht4c { namespace Odbc { namespace Db {
 		SAFE_DELETE( os_del_cf )
 		SAFE_DELETE( os_del_cell )
 		SAFE_DELETE( os_del_cell_version )
+		SAFE_DELETE( os_stage )
 		SAFE_DELETE( os )
 
 		#undef SAFE_DELETE
 
+		if( !staging.empty() ) {
+			try {
+				OdbcStm stm( table.get() );
+				odbc::otl_cursor::direct_exec( *getDb(), stm.dropStaging(staging).c_str(), odbc::otl_exception::disabled );
+			}
+			catch( ... ) {
+			}
+		}
+
+		// the dedicated session goes back to the pool
+		env->releaseDb( db );
+
 		schema = 0;
 		db = 0;
 		table = 0;
@@ -735,6 +770,7 @@ namespace ht4c { namespace Odbc { namespace Db {
 			if( p ) p->flush();
 
 		SAFE_FLUSH( os )
+		mergeStaging( );
 		SAFE_FLUSH( os_sm )
 		SAFE_FLUSH( os_del_row )
 		SAFE_FLUSH( os_del_cf )
@@ -748,6 +784,10 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 	void Mutator::insert( Hypertable::Key& key, const void* value, uint32_t valueLength ) {
 		if( valueLength > static_cast<uint32_t>(getDb()->get_max_long_size()) ) {
+			// the lob is written immediately, earlier cells must not be written after it
+			if( os ) os->flush();
+			mergeStaging( );
+
 			if( !os_sm ) {
 				OdbcStm stm( table.get() );
 				os_sm = newOdbcStream( 1, stm.insert(), getDb(), true );
@@ -763,6 +803,18 @@ namespace ht4c { namespace Odbc { namespace Db {
 			lob << varbinary(value, valueLength);
 			lob.close();
 		}
+		else if( os_stage ) {
+			*os_stage << varbinary(key.row, key.row_len)
+								<< static_cast<int>(key.column_family_code)
+								<< varbinary(CQ(key.column_qualifier), key.column_qualifier_len)
+								<< static_cast<OTL_BIGINT>(timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp)
+								<< varbinary(value, valueLength);
+
+			// the stream has been flushed as soon as the array is full
+			if( ++staged >= bulkInsertRows ) {
+				mergeStaging();
+			}
+		}
 		else {
 			*os << varbinary(key.row, key.row_len)
 					<< static_cast<int>(key.column_family_code)
@@ -772,6 +824,21 @@ namespace ht4c { namespace Odbc { namespace Db {
 		}
 	}
 
+	void Mutator::mergeStaging( ) {
+		if( staged ) {
+			// the cells have been staged after the pending deletes
+			if( os_del_row ) os_del_row->flush();
+			if( os_del_cf ) os_del_cf->flush();
+			if( os_del_cell ) os_del_cell->flush();
+			if( os_del_cell_version ) os_del_cell_version->flush();
+			os_stage->flush();
+
+			OdbcStm stm( table.get() );
+			odbc::otl_cursor::direct_exec( *getDb(), stm.mergeStaging(staging).c_str(), odbc::otl_exception::enabled );
+			staged = 0;
+		}
+	}
+
 	void Mutator::toKey( Hypertable::Schema* schema
 										 , const char* row
 										 , int rowLen
@@ -821,6 +888,9 @@ namespace ht4c { namespace Odbc { namespace Db {
 	}
 
 	void Mutator::del( Hypertable::Key& key ) {
+		// staged cells must not be merged after the delete
+		mergeStaging( );
+
 		int64_t timestamp = timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp;
 		OdbcStm stm( table.get() );
 
@@ -890,12 +960,44 @@ namespace ht4c { namespace Odbc { namespace Db {
 	Scanner::Scanner( Db::TablePtr _table, const Hypertable::ScanSpec& _scanSpec, uint32_t _flags )
 	: table( _table )
 	, flags( _flags )
-	, db( 0 )
+	, db( _table->getEnv()->acquireDb(true) )
+	, reader( 0 )
 	, scanSpec( _scanSpec )
 	{
+		try {
+			createReader( );
+			reader->stmtPrepare( );
+		}
+		catch( ... ) {
+			if( reader ) {
+				delete reader;
+				reader = 0;
+			}
+			getEnv()->releaseDb( db );
+			db = 0;
+			throw;
+		}
+	}
+
+	Scanner::~Scanner( ) {
+		if( reader ) {
+			delete reader;
+			reader = 0;
+		}
+
+		// a dedicated connection per scanner, scanners stream concurrently to the mutators
+		getEnv()->releaseDb( db );
+		db = 0;
+	}
+
+	bool Scanner::nextCell( Hypertable::Cell& cell ) {
+		return reader->nextCell( cell );
+	}
+
+	void Scanner::createReader( ) {
 		if( scanSpec.get().row_intervals.empty() ) {
 			if( scanSpec.get().cell_intervals.empty() ) {
-				reader = new Reader( getDb(), _table->getId(), _table->getSchema(), scanSpec.get() );
+				reader = new Reader( getDb(), table->getId(), table->getSchema(), scanSpec.get(), table->getEnv()->getFetchSize() );
 			}
 			else {
 				Hypertable::CellIntervals& cellIntervals = scanSpec.get().cell_intervals;
@@ -907,11 +1009,11 @@ namespace ht4c { namespace Odbc { namespace Db {
 						ci->end_row = Hypertable::Key::END_ROW_MARKER;
 					}
 				}
-				reader = new ReaderCellIntervals( getDb(), _table->getId(), _table->getSchema(), scanSpec.get() );
+				reader = new ReaderCellIntervals( getDb(), table->getId(), table->getSchema(), scanSpec.get(), table->getEnv()->getFetchSize() );
 			}
 		}
 		else if (scanSpec.get().scan_and_filter_rows) {
-			reader = new ReaderScanAndFilter( getDb(), _table->getId(), _table->getSchema(), scanSpec.get() );
+			reader = new ReaderScanAndFilter( getDb(), table->getId(), table->getSchema(), scanSpec.get(), table->getEnv()->getFetchSize() );
 		}
 		else {
 			Hypertable::RowIntervals& rowIntervals = scanSpec.get().row_intervals;
@@ -924,26 +1026,13 @@ namespace ht4c { namespace Odbc { namespace Db {
 				}
 			}
 
-			reader = new ReaderRowIntervals( getDb(), _table->getId(), _table->getSchema(), scanSpec.get() );
-		}
-
-		reader->stmtPrepare( );
-	}
-
-	Scanner::~Scanner( ) {
-		if( reader ) {
-			delete reader;
-			reader = 0;
+			reader = new ReaderRowIntervals( getDb(), table->getId(), table->getSchema(), scanSpec.get(), table->getEnv()->getFetchSize() );
 		}
-		db = 0;
-	}
-
-	bool Scanner::nextCell( Hypertable::Cell& cell ) {
-		return reader->nextCell( cell );
 	}
 
 	Scanner::ScanContext::ScanContext( const Hypertable::ScanSpec& _scanSpec, Hypertable::SchemaPtr _schema )
 	: Common::ScanContext( _scanSpec, _schema )
+	, top( 0 )
 	{
 	}
 
@@ -1000,10 +1089,70 @@ namespace ht4c { namespace Odbc { namespace Db {
 			predicate = predicate.empty() ? predicateTimestamp : Hypertable::format( "%s AND (%s)", predicateTimestamp.c_str(), predicate.c_str() );
 		}
 
+		// value predicates, SQL Server cannot evaluate regular expressions, a column family
+		// having any term which cannot be expressed is left to the client side filter
+		typedef std::vector<std::pair<std::string, std::string>> ValueTerms;
+		std::map<int, std::pair<ValueTerms, bool>> columnPredicates;
+		for each( const Hypertable::ColumnPredicate& cp in scanSpec.column_predicates ) {
+			if( cp.column_family && *cp.column_family && (cp.operation & Hypertable::ColumnPredicate::VALUE_MATCH) ) {
+				// column family has already been verified
+				std::pair<ValueTerms, bool>& cpp = columnPredicates[schema->get_column_family(cp.column_family)->get_id()];
+				if( cpp.first.empty() ) {
+					cpp.second = true;
+				}
+
+				if( cp.value_len <= 8000 ) {
+					switch( cp.operation ) {
+						case Hypertable::ColumnPredicate::EXACT_MATCH:
+							// Hypertable cannot distinguish between NULL and ""
+							if( cp.value && cp.value_len ) {
+								cpp.first.push_back( std::make_pair(std::string("v="), std::string(reinterpret_cast<const char*>(cp.value), cp.value_len)) );
+							}
+							else {
+								cpp.first.push_back( std::make_pair(std::string("v IS NULL"), std::string()) );
+							}
+							continue;
+						case Hypertable::ColumnPredicate::PREFIX_MATCH:
+							if( cp.value && cp.value_len ) {
+								cpp.first.push_back( std::make_pair(Hypertable::format("SUBSTRING(v,1,%u)=", cp.value_len), std::string(reinterpret_cast<const char*>(cp.value), cp.value_len)) );
+								continue;
+							}
+							break;
+						default:
+							break;
+					}
+				}
+				cpp.second = false;
+			}
+		}
+
+		std::string predicateValue;
+		for( std::map<int, std::pair<ValueTerms, bool>>::const_iterator it = columnPredicates.begin(); it != columnPredicates.end(); ++it ) {
+			if( (*it).second.second ) {
+				std::string terms;
+				for each( const std::pair<std::string, std::string>& term in (*it).second.first ) {
+					terms += terms.empty() ? term.first : " OR " + term.first;
+					if( !term.second.empty() ) {
+						terms += addParam( term.second, 8000 );
+					}
+				}
+				predicateValue += Hypertable::format( "%s(cf<>%d OR %s)", predicateValue.empty() ? "" : " AND ", (*it).first, terms.c_str() );
+			}
+		}
+
+		if( !predicateValue.empty() ) {
+			predicate = predicate.empty() ? predicateValue : Hypertable::format( "(%s) AND %s", predicate.c_str(), predicateValue.c_str() );
+		}
+
 		columns = "r:#1<raw[512]>, cf, cq:#3<raw[512]>, ts";
 		if( !keysOnly ) {
 			columns += ", v:#5<raw_long>";
 		}
+
+		// the cell limit can be applied by the query if each selected row yields a cell
+		if( cellLimit > 0 && !hasClientFilter(hasTimeOrderAsc != hasTimeOrderDesc) ) {
+			top = cellOffset + cellLimit;
+		}
 	}
 
 	void Scanner::ScanContext::initialColumn( Hypertable::ColumnFamilySpec* cf, bool hasQualifier, bool isRegexp, bool isPrefix, const std::string& qualifier ) {
@@ -1011,18 +1160,63 @@ namespace ht4c { namespace Odbc { namespace Db {
 			cfPredicate += Hypertable::format( "%s'%d'", cfPredicate.empty() ? "" : ",", cf->get_id() );
 		}
 		else if (isPrefix) {
-			qPredicate += Hypertable::format( "%s(cf=%d AND cq>=%s)", qPredicate.empty() ? "" : " OR ", cf->get_id(), nhex(qualifier).c_str() );
+			// prefix range, the upper bound is the prefix with its last byte incremented
+			std::string upper( qualifier );
+			while( !upper.empty() && static_cast<uint8_t>(*upper.rbegin()) == 0xff ) {
+				upper.erase( upper.size() - 1 );
+			}
+			if( !upper.empty() ) {
+				++(*upper.rbegin());
+				qPredicate += Hypertable::format( "%s(cf=%d AND cq>=", qPredicate.empty() ? "" : " OR ", cf->get_id() ) + addParam( qualifier, 512 );
+				qPredicate += " AND cq<" + addParam( upper, 512 ) + ")";
+			}
+			else {
+				qPredicate += Hypertable::format( "%s(cf=%d AND cq>=", qPredicate.empty() ? "" : " OR ", cf->get_id() ) + addParam( qualifier, 512 ) + ")";
+			}
 		}
 		else {
-			qPredicate += Hypertable::format( "%s(cf=%d AND cq=%s)", qPredicate.empty() ? "" : " OR ", cf->get_id(), hex(qualifier).c_str() );
+			qPredicate += Hypertable::format( "%s(cf=%d AND cq=", qPredicate.empty() ? "" : " OR ", cf->get_id() ) + addParam( qualifier, 512 ) + ")";
 		}
 	}
 
-	Scanner::Reader::Reader( odbc::otl_connect* _db, const std::string& _tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec )
+	std::string Scanner::ScanContext::addParam( const std::string& value, int size ) {
+		// parameters are bound in the order of their placeholders
+		params.push_back( value );
+		return Hypertable::format( ":p%d<raw[%d]>", static_cast<int>(params.size()), size );
+	}
+
+	bool Scanner::ScanContext::hasClientFilter( bool timestampPredicate ) const {
+		if( rowRegexp || valueRegexp || !rowset.empty() || rowOffset || cellLimitPerFamily || scanSpec.column_predicates.size() ) {
+			return true;
+		}
+
+		if( !timestampPredicate && (timeInterval.first > Hypertable::TIMESTAMP_MIN || timeInterval.second < Hypertable::TIMESTAMP_MAX) ) {
+			return true;
+		}
+
+		const Hypertable::ColumnFamilySpecs& families = schema->get_column_families();
+		for each( const Hypertable::ColumnFamilySpec* cf in families ) {
+			const CellFilterInfo& cfi = familyInfo[cf->get_id()];
+			if( familyMask[cf->get_id()] ) {
+				if( cfi.cutoffTime > Hypertable::TIMESTAMP_MIN || cfi.maxVersions || cfi.hasQualifierRegexpFilter() ) {
+					return true;
+				}
+			}
+			else if( cfPredicate.empty() && qPredicate.empty() ) {
+				// unselected column family has not been excluded by the query
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	Scanner::Reader::Reader( odbc::otl_connect* _db, const std::string& _tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec, int fetchSize )
 	: db( _db )
 	, os( 0 )
 	, tableId( _tableId )
 	, scanContext( new ScanContext(scanSpec, schema) )
+	, fetchRows( 1 )
 	, currkey( 64 )
 	, prevKey( 64 )
 	, prevColumnFamilyCode( -1 )
@@ -1039,6 +1233,10 @@ namespace ht4c { namespace Odbc { namespace Db {
 		for each( const Hypertable::ColumnFamilySpec* cf in families ) {
 			timeOrderAsc[cf->get_id()] = !cf->get_option_time_order_desc();
 		}
+
+		// rows per round trip, sized by the maximum row buffer
+		int rowSize = static_cast<int>( 512 + sizeof(int) + 512 + sizeof(OTL_BIGINT) ) + (scanContext->keysOnly ? 0 : db->get_max_long_size());
+		fetchRows = std::max( 1, std::min(fetchSize / rowSize, 32767) );
 	}
 
 #define READER_DELETE_OS			\
@@ -1100,7 +1298,21 @@ namespace ht4c { namespace Odbc { namespace Db {
 		}
 
 		OdbcStm stm( tableId );
-		os = newOdbcStream( 16, stm.select(scanContext->columns, predicate), db );
+		os = newOdbcStream( fetchRows, stm.select(selectColumns(true), predicate), db );
+		bindParams();
+	}
+
+	std::string Scanner::Reader::selectColumns( bool limit ) const {
+		if( limit && scanContext->top ) {
+			return Hypertable::format( "TOP (%d) %s", scanContext->top, scanContext->columns.c_str() );
+		}
+		return scanContext->columns;
+	}
+
+	void Scanner::Reader::bindParams( ) {
+		for each( const std::string& param in scanContext->params ) {
+			*os << varbinary( param.c_str(), static_cast<int>(param.size()) );
+		}
 	}
 
 	bool Scanner::Reader::moveNext( ) {
@@ -1142,15 +1354,8 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 		CellFilterInfo& cfi = scanContext->familyInfo[key.column_family_code];
 
-		// cutoff time
+		// cutoff time, expired cells are erased by the background purge
 		if( key.timestamp < cfi.cutoffTime ) {
-			OdbcStm stm( tableId );
-			odbc::otl_stream os( 1, stm.deleteCutoffTime().c_str(), *db );
-
-				os << varbinary(key.row, key.row_len)
-					 << static_cast<int>(key.column_family_code)
-					 << static_cast<OTL_BIGINT>(timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp);
-
 			return 0;
 		}
 
@@ -1297,8 +1502,8 @@ namespace ht4c { namespace Odbc { namespace Db {
 		return true;
 	}
 
-	Scanner::ReaderScanAndFilter::ReaderScanAndFilter( odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec )
-	: Reader( db, tableId, schema, scanSpec )
+	Scanner::ReaderScanAndFilter::ReaderScanAndFilter( odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec, int fetchSize )
+	: Reader( db, tableId, schema, scanSpec, fetchSize )
 	{
 	}
 
@@ -1312,18 +1517,19 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 		OdbcStm stm( tableId );
 		if( strcmp(*scanContext->rowset.begin(),*scanContext->rowset.rbegin()) ) {
-			os = newOdbcStream( 16, stm.selectRowInterval(scanContext->columns, predicate), db );
+			os = newOdbcStream( fetchRows, stm.selectRowInterval(scanContext->columns, predicate), db );
 			*os << varbinary(*scanContext->rowset.begin())
 				  << varbinary(*scanContext->rowset.rbegin());
 		}
 		else {
-			os = newOdbcStream( 16, stm.selectRow(scanContext->columns, predicate), db );
+			os = newOdbcStream( fetchRows, stm.selectRow(scanContext->columns, predicate), db );
 			*os << varbinary(*scanContext->rowset.begin());
 		}
+		bindParams();
 	}
 
-	Scanner::ReaderRowIntervals::ReaderRowIntervals( odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec )
-	: Reader( db, tableId, schema, _scanSpec )
+	Scanner::ReaderRowIntervals::ReaderRowIntervals( odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec, int fetchSize )
+	: Reader( db, tableId, schema, _scanSpec, fetchSize )
 	, scanSpec( _scanSpec )
 	, it( _scanSpec.row_intervals.begin() )
 	, rowIntervalDone( true )
@@ -1356,14 +1562,15 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 			OdbcStm stm( tableId );
 			if( strcmp(it->start, it->end) ) {
-				os = newOdbcStream( 16, stm.selectRowInterval(scanContext->columns, predicate, it->start_inclusive, it->end_inclusive), db );
+				os = newOdbcStream( fetchRows, stm.selectRowInterval(selectColumns(true), predicate, it->start_inclusive, it->end_inclusive), db );
 				*os << varbinary(it->start)
 				    << varbinary(it->end);
 			}
 			else {
-				os = newOdbcStream( 16, stm.selectRow(scanContext->columns, predicate), db );
+				os = newOdbcStream( fetchRows, stm.selectRow(selectColumns(true), predicate), db );
 				*os << varbinary(it->start);
 			}
+			bindParams();
 		}
 
 		if( os->eof() ) {
@@ -1375,8 +1582,8 @@ namespace ht4c { namespace Odbc { namespace Db {
 		return true;
 	}
 
-	Scanner::ReaderCellIntervals::ReaderCellIntervals( odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec )
-	: Reader( db, tableId, schema, _scanSpec )
+	Scanner::ReaderCellIntervals::ReaderCellIntervals( odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& _scanSpec, int fetchSize )
+	: Reader( db, tableId, schema, _scanSpec, fetchSize )
 	, scanSpec( _scanSpec )
 	, it( _scanSpec.cell_intervals.begin() )
 	, startColumnQualifier( 0 )
@@ -1444,20 +1651,37 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 			OdbcStm stm( tableId );
 			if( strcmp(it->start_row, it->end_row) ) {
-				os = newOdbcStream( 16, stm.selectRowInterval(scanContext->columns, predicate), db );
+				os = newOdbcStream( fetchRows, stm.selectRowInterval(scanContext->columns, predicate), db );
 				*os << varbinary(it->start_row)
 				    << varbinary(it->end_row);
+				bindParams();
 			}
 			else if( startColumnFamilyCode != endColumnFamilyCode ) {
-				os = newOdbcStream( 16, stm.selectRowColumnFamilyInterval(scanContext->columns, predicate), db );
+				os = newOdbcStream( fetchRows, stm.selectRowColumnFamilyInterval(scanContext->columns, predicate), db );
 				*os << varbinary(it->start_row)
 						<< static_cast<int>(startColumnFamilyCode)
 						<< static_cast<int>(endColumnFamilyCode);
+				bindParams();
 			}
 			else {
-				os = newOdbcStream( 16, stm.selectRowColumnFamily(scanContext->columns, predicate), db );
+				// single row and column family, the qualifier range can be applied by the query
+				if( startColumnQualifier ) {
+					predicate += Hypertable::format( " AND cq>%s:cq1<raw[512]>", cmpStart ? "" : "=" );
+				}
+				if( endColumnQualifier ) {
+					predicate += Hypertable::format( " AND cq<%s:cq2<raw[512]>", cmpEnd ? "" : "=" );
+				}
+
+				os = newOdbcStream( fetchRows, stm.selectRowColumnFamily(scanContext->columns, predicate), db );
 				*os << varbinary(it->start_row)
 						<< static_cast<int>(startColumnFamilyCode);
+				bindParams();
+				if( startColumnQualifier ) {
+					*os << varbinary(startColumnQualifier);
+				}
+				if( endColumnQualifier ) {
+					*os << varbinary(endColumnQualifier);
+				}
 			}
 		}
 
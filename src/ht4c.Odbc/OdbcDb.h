@@ -219,6 +219,7 @@ namespace ht4c { namespace Odbc { namespace Db {
 		private:
 
 			void insert( Hypertable::Key& key, const void* value, uint32_t valueLength );
+			void mergeStaging( );
 			void set( Hypertable::Key& key, const void* value, uint32_t valueLength );
 			void del( Hypertable::Key& key );
 			void toKey( Hypertable::Schema* schema
@@ -265,7 +266,7 @@ namespace ht4c { namespace Odbc { namespace Db {
 			}
 
 			inline odbc::otl_connect* getDb( ) {
-				return db ? db : db = getEnv()->getDb();
+				return db;
 			}
 
 			Db::TablePtr table;
@@ -278,6 +279,10 @@ namespace ht4c { namespace Odbc { namespace Db {
 			odbc::otl_stream* os_del_cf;
 			odbc::otl_stream* os_del_cell;
 			odbc::otl_stream* os_del_cell_version;
+			odbc::otl_stream* os_stage;
+			std::string staging;
+			int bulkInsertRows;
+			int staged;
 			OdbcEnv* env;
 			Hypertable::Schema* schema;
 			enum {
@@ -337,17 +342,24 @@ namespace ht4c { namespace Odbc { namespace Db {
 					std::string cfPredicate;
 					std::string qPredicate;
 					std::string columns;
+					std::vector<std::string> params;
+					int top;
 
 			protected:
 
 				virtual void initialColumn( Hypertable::ColumnFamilySpec* cf, bool hasQualifier, bool isRegexp, bool isPrefix, const std::string& qualifier );
+
+			private:
+
+				std::string addParam( const std::string& value, int size );
+				bool hasClientFilter( bool timestampPredicate ) const;
 			};
 
 			class Reader {
 
 				public:
 
-					Reader(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec);
+					Reader(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec, int fetchSize);
 					virtual ~Reader();
 
 					virtual void stmtPrepare( );
@@ -362,11 +374,14 @@ namespace ht4c { namespace Odbc { namespace Db {
 						eos = true;
 					}
 					bool getCell( const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell );
+					std::string selectColumns( bool limit ) const;
+					void bindParams( );
 
 					odbc::otl_connect* db;
 					odbc::otl_stream* os;
 					std::string tableId;
 					ScanContext* scanContext;
+					int fetchRows;
 					int rowCount;
 					int cellCount;
 					int cellPerFamilyCount;
@@ -396,7 +411,7 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 				public:
 
-					ReaderScanAndFilter(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec);
+					ReaderScanAndFilter(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec, int fetchSize);
 
 					virtual void stmtPrepare( );
 			};
@@ -405,7 +420,7 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 				public:
 
-					ReaderRowIntervals(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec);
+					ReaderRowIntervals(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec, int fetchSize);
 
 					virtual void stmtPrepare( );
 
@@ -428,7 +443,7 @@ namespace ht4c { namespace Odbc { namespace Db {
 
 				public:
 
-					ReaderCellIntervals(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec);
+					ReaderCellIntervals(odbc::otl_connect* db, const std::string& tableId, Hypertable::SchemaPtr schema, const Hypertable::ScanSpec& scanSpec, int fetchSize);
 
 					virtual void stmtPrepare( );
 
@@ -459,8 +474,10 @@ namespace ht4c { namespace Odbc { namespace Db {
 					bool cellIntervalDone;
 			};
 
+			void createReader( );
+
 			inline odbc::otl_connect* getDb( ) {
-				return db ? db : db = getEnv()->getDb();
+				return db;
 			}
 
 			Db::TablePtr table;
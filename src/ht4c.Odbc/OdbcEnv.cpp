@@ -54,13 +54,44 @@ namespace ht4c { namespace Odbc {
 	, indexColumnFamily( config.indexColumnFamily )
 	, indexColumnQualifier( config.indexColumnQualifier )
 	, indexTimestamp( config.indexTimestamp )
+	, clusteredKey( false )
+	, columnstore( false )
+	, bulkInsertRows( std::max(0, config.bulkInsertRows) )
+	, fetchSize( std::max(1, config.fetchSizeKB) * 1024 )
+	, maxConnections( std::max(1, config.maxConnections) )
+	, lockTimeout( std::max(0, config.lockTimeoutMsec) )
+	, snapshotIsolation( false )
+	, purgeBatchCells( std::max(1, config.purgeBatchCells) )
+	, purgeTimer( 0 )
+	, purging( 0 )
 	{
 		::InitializeCriticalSection( &mtxEnv );
+		::InitializeCriticalSection( &mtxPool );
 
 		odbc::otl_connect::otl_initialize();
 		odbc::otl_connect* db;
 
 		HT4C_TRY {
+			if( !stricmp(config.tableLayout.c_str(), "clustered") ) {
+				clusteredKey = true;
+			}
+			else if( !stricmp(config.tableLayout.c_str(), "columnstore") ) {
+				columnstore = true;
+			}
+			else if( stricmp(config.tableLayout.c_str(), "heap") ) {
+				HT4C_ODBC_THROW( Hypertable::Error::CONFIG_BAD_VALUE, Hypertable::format("Invalid table layout '%s'", config.tableLayout.c_str()).c_str() );
+			}
+
+			if( !stricmp(config.tableCompression.c_str(), "row") ) {
+				tableCompression = "ROW";
+			}
+			else if( !stricmp(config.tableCompression.c_str(), "page") ) {
+				tableCompression = "PAGE";
+			}
+			else if( stricmp(config.tableCompression.c_str(), "none") ) {
+				HT4C_ODBC_THROW( Hypertable::Error::CONFIG_BAD_VALUE, Hypertable::format("Invalid table compression '%s'", config.tableCompression.c_str()).c_str() );
+			}
+
 			try {
 				db = getDb();
 
@@ -79,11 +110,36 @@ namespace ht4c { namespace Odbc {
 					throw;
 				}
 			}
+
+			// scanners read row versions instead of waiting for the row locks of unflushed mutators
+			{
+				odbc::otl_stream os( 1, OdbcStm::snapshotIsolation().c_str(), *getDb() );
+				if( !os.eof() ) {
+					int snapshot;
+					os >> snapshot;
+					snapshotIsolation = snapshot != 0;
+				}
+			}
+			getDb()->commit();
+
+			// expires cells in the background, scanners just skip them
+			if( config.purgeIntervalMsec > 0 ) {
+				DWORD interval = config.purgeIntervalMsec;
+				if( !::CreateTimerQueueTimer(&purgeTimer, 0, purgeTimerProc, this, interval, interval, WT_EXECUTELONGFUNCTION) ) {
+					purgeTimer = 0;
+				}
+			}
 		}
 		HT4C_ODBC_RETHROW
 	}
 
 	OdbcEnv::~OdbcEnv( ) throw(ht4c::Common::HypertableException) {
+			if( purgeTimer ) {
+				// waits for a running purge to complete
+				::DeleteTimerQueueTimer( 0, purgeTimer, INVALID_HANDLE_VALUE );
+				purgeTimer = 0;
+			}
+
 			{
 				boost::lock_guard<boost::mutex> lock( mtxEnvironments );
 				environments.erase( this );
@@ -121,6 +177,7 @@ namespace ht4c { namespace Odbc {
 				releasedConnections.clear();
 			}
 
+			::DeleteCriticalSection( &mtxPool );
 			::DeleteCriticalSection( &mtxEnv );
 		}
 		HT4C_ODBC_RETHROW
@@ -137,7 +194,7 @@ namespace ht4c { namespace Odbc {
 		odbc::otl_connect* db;
 		{
 			DWORD threadId = ::GetCurrentThreadId();
-			OdbcEnvLock lock( this );
+			PoolLock lock( this );
 			connections_t::iterator it = connections.find( threadId );
 			if( it != connections.end() ) {
 				return (*it).second;
@@ -157,12 +214,71 @@ namespace ht4c { namespace Odbc {
 		return db;
 	}
 
+	odbc::otl_connect* OdbcEnv::acquireDb( bool readOnly ) {
+		odbc::otl_connect* db = 0;
+		{
+			// only idle connections are bounded, a busy pool opens another connection
+			// rather than making the caller wait for a release
+			PoolLock lock( this );
+			if( releasedConnections.size() ) {
+				db = releasedConnections.back();
+				releasedConnections.pop_back();
+			}
+		}
+
+		try {
+			if( !db ) {
+				db = new odbc::otl_connect();
+				setupConnection( db );
+			}
+
+			// unflushed mutations hold their row locks, scanners must not wait for them without bound
+			if( readOnly ) {
+				odbc::otl_cursor::direct_exec( *db, OdbcStm::scannerSession(snapshotIsolation, lockTimeout).c_str(), odbc::otl_exception::enabled );
+			}
+		}
+		catch( ... ) {
+			delete db;
+			throw;
+		}
+		return db;
+	}
+
+	void OdbcEnv::releaseDb( odbc::otl_connect* db ) {
+		if( db ) {
+			bool reusable = true;
+			try {
+				// ends the read or write transaction of the session and restores the session defaults
+				db->rollback();
+				odbc::otl_cursor::direct_exec( *db, OdbcStm::resetSession().c_str(), odbc::otl_exception::enabled );
+			}
+			catch( odbc::otl_exception& ) {
+				reusable = false;
+			}
+
+			{
+				PoolLock lock( this );
+				if( reusable && releasedConnections.size() < maxConnections ) {
+					releasedConnections.push_back( db );
+					return;
+				}
+			}
+
+			try {
+				db->logoff();
+			}
+			catch( odbc::otl_exception& ) {
+			}
+			delete db;
+		}
+	}
+
 	void OdbcEnv::onThreadExit() {
 		odbc::otl_connect* db;
 
 		{
 			DWORD threadId = ::GetCurrentThreadId();
-			OdbcEnvLock lock( this );
+			PoolLock lock( this );
 			connections_t::iterator it = connections.find( threadId );
 			if( it == connections.end() ) {
 				return;
@@ -171,7 +287,7 @@ namespace ht4c { namespace Odbc {
 			db = (*it).second;
 			connections.erase( it );
 
-			if( connections.size() + releasedConnections.size() < MaxConnections ) {
+			if( connections.size() + releasedConnections.size() < maxConnections ) {
 				releasedConnections.push_back( db );
 				return;
 			}
@@ -279,7 +395,7 @@ namespace ht4c { namespace Odbc {
 		sysDbInsert( db, name, len, value, size, &id );
 
 		OdbcStm stm( id );
-		odbc::otl_cursor::direct_exec( *db, stm.createTable().c_str(), odbc::otl_exception::enabled );
+		odbc::otl_cursor::direct_exec( *db, stm.createTable(clusteredKey, columnstore, tableCompression).c_str(), odbc::otl_exception::enabled );
 
 		if( indexColumn ) {
 			odbc::otl_cursor::direct_exec(
@@ -373,6 +489,93 @@ namespace ht4c { namespace Odbc {
 		return false;
 	}
 
+	void OdbcEnv::purge( ) {
+		odbc::otl_connect* db = acquireDb();
+		try {
+			// snapshot of the table schemas
+			std::vector<std::pair<std::string, std::string>> schemas;
+			{
+				odbc::otl_stream os( 64, OdbcStm::sysDbQueryTables().c_str(), *db );
+				while( !os.eof() ) {
+					varbinary pk, v;
+					os >> pk >> v;
+					schemas.push_back( std::make_pair(std::string(pk.c_str()), std::string(v.c_str())) );
+				}
+			}
+			db->commit();
+
+			for each( const std::pair<std::string, std::string>& schema in schemas ) {
+				try {
+					purgeTable( db, schema.first, schema.second );
+				}
+				catch( odbc::otl_exception& ) {
+					// table might have been dropped in the meantime
+					db->rollback();
+				}
+			}
+		}
+		catch( ... ) {
+			releaseDb( db );
+			throw;
+		}
+		releaseDb( db );
+	}
+
+	void OdbcEnv::purgeTable( odbc::otl_connect* db, const std::string& id, const std::string& schemaSpec ) {
+		Hypertable::SchemaPtr schema( Hypertable::Schema::new_instance(schemaSpec) );
+		int64_t now = Hypertable::get_ts64();
+
+		OdbcStm stm( id );
+		bool indexed = false;
+		for each( const Hypertable::ColumnFamilySpec* cf in schema->get_column_families() ) {
+			if( cf->get_deleted() || cf->get_option_ttl() == 0 ) {
+				continue;
+			}
+
+			// the deletes seek by (cf, ts), without an index each batch scans the whole table,
+			// created on demand since a ttl might have been added by altering the table
+			if( !indexed ) {
+				odbc::otl_cursor::direct_exec( *db, stm.createPurgeIndex().c_str(), odbc::otl_exception::enabled );
+				db->commit();
+				indexed = true;
+			}
+
+			// timestamps are stored complemented for ascending time order
+			bool timeOrderAsc = !cf->get_option_time_order_desc();
+			int64_t cutoffTime = now - ((int64_t)cf->get_option_ttl() * 1000000000LL);
+
+			// one small transaction per batch, do not block the mutators
+			odbc::otl_stream os( 1, stm.deleteCutoffTime(timeOrderAsc).c_str(), *db );
+			for( long n = purgeBatchCells; n >= purgeBatchCells; ) {
+				os << purgeBatchCells
+					 << static_cast<int>(cf->get_id())
+					 << static_cast<OTL_BIGINT>(timeOrderAsc ? ~cutoffTime : cutoffTime);
+
+				os.flush();
+				n = os.get_rpc();
+				db->commit();
+
+				if( n >= purgeBatchCells ) {
+					::SwitchToThread();
+				}
+			}
+		}
+	}
+
+	VOID CALLBACK OdbcEnv::purgeTimerProc( void* param, BOOLEAN /*timerOrWaitFired*/ ) {
+		OdbcEnv* env = reinterpret_cast<OdbcEnv*>( param );
+
+		// skips the period if the previous purge is still running
+		if( ::InterlockedCompareExchange(&env->purging, 1, 0) == 0 ) {
+			try {
+				env->purge();
+			}
+			catch( ... ) {
+			}
+			::InterlockedExchange( &env->purging, 0 );
+		}
+	}
+
 	void OdbcEnv::setupConnection( odbc::otl_connect* db ) {
 		db->set_connection_mode( odbc::OTL_MSSQL_2008_ODBC_CONNECT );
 		db->set_stream_pool_size( 32 ); 
@@ -63,6 +63,14 @@ namespace ht4c { namespace Odbc {
 
 			Common::Client* createClient( );
 			odbc::otl_connect* getDb();
+			odbc::otl_connect* acquireDb( bool readOnly = false );
+			void releaseDb( odbc::otl_connect* db );
+			inline int getBulkInsertRows( ) const {
+				return bulkInsertRows;
+			}
+			inline int getFetchSize( ) const {
+				return fetchSize;
+			}
 
 			void onThreadExit();
 
@@ -100,24 +108,58 @@ namespace ht4c { namespace Odbc {
 
 		private:
 
+			class PoolLock {
+
+				public:
+
+					inline PoolLock( OdbcEnv* _env )
+					: env( _env ) {
+						env->lockPool();
+					}
+					inline ~PoolLock( ) {
+						env->unlockPool();
+					}
+
+				private:
+
+					OdbcEnv* env;
+			};
+			friend class PoolLock;
+
 			inline void lock( ) {
 				::EnterCriticalSection( &mtxEnv );
 			}
 			inline void unlock( ) {
 				::LeaveCriticalSection( &mtxEnv );
 			}
-
-			enum {
-				MaxConnections = 8
-			};
+			inline void lockPool( ) {
+				::EnterCriticalSection( &mtxPool );
+			}
+			inline void unlockPool( ) {
+				::LeaveCriticalSection( &mtxPool );
+			}
 
 			void setupConnection( odbc::otl_connect* db );
+			void purge( );
+			void purgeTable( odbc::otl_connect* db, const std::string& id, const std::string& schemaSpec );
+			static VOID CALLBACK purgeTimerProc( void* param, BOOLEAN timerOrWaitFired );
 
 			std::string connectionString;
 			bool indexColumn;
 			bool indexColumnFamily;
 			bool indexColumnQualifier;
 			bool indexTimestamp;
+			bool clusteredKey;
+			bool columnstore;
+			std::string tableCompression;
+			int bulkInsertRows;
+			int fetchSize;
+			size_t maxConnections;
+			int lockTimeout;
+			bool snapshotIsolation;
+			int purgeBatchCells;
+			HANDLE purgeTimer;
+			volatile LONG purging;
 
 			typedef std::map<DWORD, odbc::otl_connect*> connections_t;
 			connections_t connections;
@@ -129,6 +171,7 @@ namespace ht4c { namespace Odbc {
 			tables_t tables;
 
 			CRITICAL_SECTION mtxEnv;
+			CRITICAL_SECTION mtxPool;
 	};
 	typedef boost::intrusive_ptr<OdbcEnv> OdbcEnvPtr;
 
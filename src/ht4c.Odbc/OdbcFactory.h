@@ -40,12 +40,28 @@ namespace ht4c { namespace Odbc {
 		bool indexColumnFamily;
 		bool indexColumnQualifier;
 		bool indexTimestamp;
+		int bulkInsertRows;
+		int maxConnections;
+		int lockTimeoutMsec;
+		int purgeIntervalMsec;
+		int purgeBatchCells;
+		int fetchSizeKB;
+		std::string tableLayout;
+		std::string tableCompression;
 
 		OdbcEnvConfig( )
 			: indexColumn( false )
 			, indexColumnFamily( false )
 			, indexColumnQualifier( false )
 			, indexTimestamp( false )
+			, bulkInsertRows( 0 )
+			, maxConnections( 8 )
+			, lockTimeoutMsec( 30000 )
+			, purgeIntervalMsec( 60000 )
+			, purgeBatchCells( 1000 )
+			, fetchSizeKB( 1024 )
+			, tableLayout( "heap" )
+			, tableCompression( "none" )
 		{
 		}
 	};
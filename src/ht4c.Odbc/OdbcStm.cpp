@@ -79,12 +79,49 @@ namespace ht4c { namespace Odbc {
 		return "SELECT k:#1<raw[512]>, v:#2<raw[4096]> FROM sys_db WHERE k>:k<raw[512]> ORDER BY k;";
 	}
 
-	std::string OdbcStm::createTable( ) const {
+	std::string OdbcStm::sysDbQueryTables( ) {
+		return "SELECT id:#1<raw[37]>, v:#2<raw[4096]> FROM sys_db WHERE v IS NOT NULL;";
+	}
+
+	std::string OdbcStm::snapshotIsolation( ) {
+		// read committed snapshot already applies row versioning to the default isolation level
+		return "SELECT CASE WHEN snapshot_isolation_state=1 AND is_read_committed_snapshot_on=0 THEN 1 ELSE 0 END:#1<int> FROM sys.databases WHERE database_id=DB_ID();";
+	}
+
+	std::string OdbcStm::scannerSession( bool snapshot, int lockTimeout ) {
+		return Hypertable::format( "%sSET LOCK_TIMEOUT %d;", snapshot ? "SET TRANSACTION ISOLATION LEVEL SNAPSHOT;" : "", lockTimeout );
+	}
+
+	std::string OdbcStm::resetSession( ) {
+		return "SET TRANSACTION ISOLATION LEVEL READ COMMITTED;SET LOCK_TIMEOUT -1;";
+	}
+
+	std::string OdbcStm::createTable( bool clusteredKey, bool columnstore, const std::string& compression ) const {
+		if( columnstore ) {
+			// columnstore compression replaces row/page compression, the unique key index
+			// keeps the merges, deletes and ordered scans seekable
+			return Hypertable::format(
+					"CREATE TABLE "
+					"%s (r VARBINARY(512) NOT NULL, cf INTEGER NOT NULL, cq VARBINARY(512) NOT NULL, ts BIGINT NOT NULL, v VARBINARY(MAX),"
+					"UNIQUE NONCLUSTERED(r, cf, cq, ts));"
+					"CREATE CLUSTERED COLUMNSTORE INDEX cci ON %s;",
+					tableId.c_str(),
+					tableId.c_str());
+		}
+
+		std::string dataCompression;
+		if( !compression.empty() ) {
+			dataCompression = Hypertable::format( " WITH (DATA_COMPRESSION = %s)", compression.c_str() );
+		}
+
 		return Hypertable::format(
 				"CREATE TABLE "
 				"%s (r VARBINARY(512) NOT NULL, cf INTEGER NOT NULL, cq VARBINARY(512) NOT NULL, ts BIGINT NOT NULL, v VARBINARY(MAX),"
-				"UNIQUE(r, cf, cq, ts));",
-				tableId.c_str());
+				"%s(r, cf, cq, ts)%s)%s;",
+				tableId.c_str(),
+				clusteredKey ? "PRIMARY KEY CLUSTERED" : "UNIQUE",
+				dataCompression.c_str(),
+				dataCompression.c_str());
 	}
 
 	std::string OdbcStm::deleteTable( ) const {
@@ -115,6 +152,41 @@ namespace ht4c { namespace Odbc {
 				tableId.c_str());
 	}
 
+	std::string OdbcStm::createStaging( const std::string& staging ) const {
+		// session local, n keeps the insert order of the staged cells
+		return Hypertable::format(
+				"CREATE TABLE "
+				"%s (n BIGINT IDENTITY(1,1) PRIMARY KEY, r VARBINARY(512) NOT NULL, cf INTEGER NOT NULL, cq VARBINARY(512) NOT NULL, ts BIGINT NOT NULL, v VARBINARY(MAX));",
+				staging.c_str());
+	}
+
+	std::string OdbcStm::insertStaging( const std::string& staging ) const {
+		return Hypertable::format(
+				"INSERT INTO %s (r, cf, cq, ts, v) VALUES(:r<raw[512]>, :cf<int>, :cq<raw[512]>, :ts<bigint>, :v<raw_long>);",
+				staging.c_str());
+	}
+
+	std::string OdbcStm::mergeStaging( const std::string& staging ) const {
+		// MERGE fails if a target row matches more than one source row, the last staged cell wins
+		return Hypertable::format(
+				"MERGE INTO %s AS t "
+				"USING (SELECT r, cf, cq, ts, v FROM "
+				"(SELECT r, cf, cq, ts, v, ROW_NUMBER() OVER (PARTITION BY r, cf, cq, ts ORDER BY n DESC) AS k FROM %s) AS d WHERE k=1) AS s "
+				"ON (t.r=s.r AND t.cf=s.cf AND t.cq=s.cq AND t.ts=s.ts) "
+				"WHEN NOT MATCHED THEN INSERT (r, cf, cq, ts, v) VALUES (s.r, s.cf, s.cq, s.ts, s.v) "
+				"WHEN MATCHED THEN UPDATE SET v = s.v;"
+				"TRUNCATE TABLE %s;",
+				tableId.c_str(),
+				staging.c_str(),
+				staging.c_str());
+	}
+
+	std::string OdbcStm::dropStaging( const std::string& staging ) const {
+		return Hypertable::format(
+				"DROP TABLE %s;",
+				staging.c_str());
+	}
+
 	std::string OdbcStm::deleteRow( ) const {
 		return Hypertable::format(
 				"DELETE FROM %s WHERE r=:r<raw[512]> AND ts>:ts<bigint>",
@@ -139,12 +211,20 @@ namespace ht4c { namespace Odbc {
 				tableId.c_str());
 	}
 
-	std::string OdbcStm::deleteCutoffTime( ) const {
+	std::string OdbcStm::createPurgeIndex( ) const {
 		return Hypertable::format(
-				"DELETE FROM %s WHERE r=:r<raw[512]> AND cf=:cf<int> AND ts>:ts<bigint>",
+				"IF NOT EXISTS (SELECT 1 FROM sys.indexes WHERE name='i_cfts' AND object_id=OBJECT_ID('%s')) CREATE INDEX i_cfts ON %s (cf, ts);",
+				tableId.c_str(),
 				tableId.c_str());
 	}
 
+	std::string OdbcStm::deleteCutoffTime( bool timeOrderAsc ) const {
+		return Hypertable::format(
+				"DELETE TOP (:n<int>) FROM %s WHERE cf=:cf<int> AND ts%c:ts<bigint>",
+				tableId.c_str(),
+				timeOrderAsc ? '>' : '<');
+	}
+
 	std::string OdbcStm::select( const std::string& columns, const std::string& predicate ) const {
 		return Hypertable::format(
 				"SELECT %s FROM %s%s ORDER BY r, cf, cq, ts;", 
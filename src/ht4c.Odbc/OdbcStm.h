@@ -53,16 +53,25 @@ namespace ht4c { namespace Odbc {
 		static std::string sysDbDelete( );
 		static std::string sysDbQueryKey( );
 		static std::string sysDbQueryKeyAndValue( );
+		static std::string sysDbQueryTables( );
+		static std::string snapshotIsolation( );
+		static std::string scannerSession( bool snapshot, int lockTimeout );
+		static std::string resetSession( );
 
-		std::string createTable( ) const;
+		std::string createTable( bool clusteredKey, bool columnstore, const std::string& compression ) const;
 		std::string deleteTable( ) const;
 
 		std::string insert( ) const;
+		std::string createStaging( const std::string& staging ) const;
+		std::string insertStaging( const std::string& staging ) const;
+		std::string mergeStaging( const std::string& staging ) const;
+		std::string dropStaging( const std::string& staging ) const;
 		std::string deleteRow( ) const;
 		std::string deleteColumnFamily( ) const;
 		std::string deleteCell( ) const;
 		std::string deleteCellVersion( ) const;
-		std::string deleteCutoffTime( ) const;
+		std::string createPurgeIndex( ) const;
+		std::string deleteCutoffTime( bool timeOrderAsc ) const;
 
 		std::string select( const std::string& columns, const std::string& predicate ) const;
 		std::string selectRowInterval( const std::string& columns, const std::string& predicate ) const;
@@ -74,18 +74,18 @@ namespace ht4c { namespace SQLite {
 			/// <param name="env">SQLite environment</param>
 			/// <returns>SQLite future</returns>
 			/// <remarks>Pure native method.</remarks>
-			//TODO Hypertable::SQLiteGen::Future get( SQLiteEnvPtr env );
+			Db::FuturePtr get( SQLiteEnvPtr env );
 
 			/// <summary>
 			/// Publish received results.
 			/// </summary>
-			/// <param name="result">SQLite serialized result</param>
+			/// <param name="result">SQLite future result</param>
 			/// <param name="asyncResult">Async result</param>
 			/// <param name="asyncResultSink">Callback for asynchronous table scan operations</param>
 			/// <param name="raiseException">If true the method raise an exception on error</param>
 			/// <returns>true if succeeded</returns>
 			/// <remarks>Pure native method.</remarks>
-			//TODO static bool publishResult( Hypertable::SQLiteGen::ResultSerialized& result, Common::AsyncResult* asyncResult, Common::AsyncResultSink* asyncResultSink, bool raiseException );
+			static bool publishResult( Db::Future::Result& result, Common::AsyncResult* asyncResult, Common::AsyncResultSink* asyncResultSink, bool raiseException );
 
 			#endif
 
@@ -123,13 +123,14 @@ namespace ht4c { namespace SQLite {
 			static DWORD WINAPI threadProc( void* param );
 
 			SQLiteEnvPtr env;
-			//TODO Hypertable::SQLiteGen::Future future;
+			Db::FuturePtr future;
 			Common::AsyncResultSink* asyncResultSink;
 			size_t capacity;
 			mutable bool cancelled;
 			int outstanding;
 			HANDLE thread;
 			bool abort;
+			bool polling;
 
 			mutable std::mutex mutex;
 			std::condition_variable cond;
@@ -39,15 +39,12 @@ namespace ht4c { namespace SQLite {
 	}
 
 	int64_t SQLiteAsyncTableMutator::id( const Db::MutatorAsyncPtr& tableMutator ) {
-		return int64_t(tableMutator.get());
+		return tableMutator->getId();
 	}
 
 	SQLiteAsyncTableMutator::~SQLiteAsyncTableMutator( ) {
 		HT4C_TRY {
-			{
-				SQLiteEnvLock sync( tableMutator->getEnv() );
-				tableMutator->flush( );
-			}
+			tableMutator->flush( );
 			tableMutator = 0;
 		}
 		HT4C_SQLITE_RETHROW
@@ -58,16 +55,12 @@ namespace ht4c { namespace SQLite {
 	}
 
 	void SQLiteAsyncTableMutator::set( const char* row, const char* columnFamily, const char* columnQualifier, uint64_t timestamp, const void* value, uint32_t valueLength, uint8_t flag ) {
-		/*HT4C_TRY {
-			flag = FLAG( columnFamily, columnQualifier, flag );
-			Hypertable::SerializedCellsWriter writer( flag == Hypertable::FLAG_INSERT ? 1024 : 128, true );
-			writer.add( row, CF(columnFamily), columnQualifier, TIMESTAMP(timestamp, flag), value, valueLength, flag );
-			writer.finalize( Hypertable::SerializedCellsFlag::EOS );
-			SQLiteEnvLock sync( env.get() );
-			env->async_set_cells_serialized( tableMutator, Hypertable::SQLiteGen::CellsSerialized(reinterpret_cast<char*>(writer.get_buffer()), writer.get_buffer_length()), false );
+		HT4C_TRY {
+			Common::Cells cells( 1 );
+			cells.add( row, columnFamily, columnQualifier, timestamp, value, valueLength, flag );
+			tableMutator->set( cells.get() );
 		}
-		HT4C_SQLITE_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_SQLITE_RETHROW
 	}
 
 	void SQLiteAsyncTableMutator::set( const char* columnFamily, const char* columnQualifier, uint64_t timestamp, const void* value, uint32_t valueLength, std::string& row ) {
@@ -76,36 +69,23 @@ namespace ht4c { namespace SQLite {
 	}
 
 	void SQLiteAsyncTableMutator::set( const Common::Cells& cells ) {
-		/*HT4C_TRY {
-			const Hypertable::Cells& _cells = cells.get();
-			Hypertable::SerializedCellsWriter writer( 8192, true );
-			for( Hypertable::Cells::const_iterator it = _cells.begin(); it != _cells.end(); ++it ) {
-				writer.add( (*it).row_key, (*it).column_family, (*it).column_qualifier, (*it).timestamp, (*it).value, (*it).value_len, (*it).flag );
-			}
-			writer.finalize( Hypertable::SerializedCellsFlag::EOS );
-			SQLiteEnvLock sync( env.get() );
-			env->async_set_cells_serialized( tableMutator, Hypertable::SQLiteGen::CellsSerialized(reinterpret_cast<char*>(writer.get_buffer()), writer.get_buffer_length()), false );
+		HT4C_TRY {
+			tableMutator->set( cells.get() );
 		}
-		HT4C_SQLITE_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_SQLITE_RETHROW
 	}
 
 	void SQLiteAsyncTableMutator::del( const char* row, const char* columnFamily, const char* columnQualifier, uint64_t timestamp ) {
-		/*HT4C_TRY {
-			uint8_t flag = FLAG_DELETE( columnFamily, columnQualifier );
-			Hypertable::SerializedCellsWriter writer( 128, true );
-			writer.add( row, CF(columnFamily), columnQualifier, TIMESTAMP(timestamp, flag), 0, 0, flag );
-			writer.finalize( Hypertable::SerializedCellsFlag::EOS );
-			SQLiteEnvLock sync( env.get() );
-			env->async_set_cells_serialized( tableMutator, Hypertable::SQLiteGen::CellsSerialized(reinterpret_cast<char*>(writer.get_buffer()), writer.get_buffer_length()), false );
+		HT4C_TRY {
+			Common::Cells cells( 1 );
+			cells.add( row, columnFamily, columnQualifier, timestamp, 0, 0, FLAG_DELETE(columnFamily, columnQualifier) );
+			tableMutator->set( cells.get() );
 		}
-		HT4C_SQLITE_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_SQLITE_RETHROW
 	}
 
 	void SQLiteAsyncTableMutator::flush() {
 		HT4C_TRY {
-			SQLiteEnvLock sync( tableMutator->getEnv() );
 			tableMutator->flush( );
 		}
 		HT4C_SQLITE_RETHROW
@@ -37,11 +37,13 @@ namespace ht4c { namespace SQLite {
 	}
 
 	int64_t SQLiteAsyncTableScanner::id( const Db::ScannerAsyncPtr& tableScanner ) {
-		return int64_t(tableScanner.get());
+		return tableScanner->getId();
 	}
 
 	SQLiteAsyncTableScanner::~SQLiteAsyncTableScanner( ) {
 		HT4C_TRY {
+			tableScanner->cancel();
+			tableScanner->wait();
 			tableScanner = 0;
 		}
 		HT4C_SQLITE_RETHROW
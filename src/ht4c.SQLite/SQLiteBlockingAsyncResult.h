@@ -61,7 +61,7 @@ namespace ht4c { namespace SQLite {
 			/// <param name="env">SQLite environment</param>
 			/// <returns>SQLite future</returns>
 			/// <remarks>Pure native method.</remarks>
-			//TODO Hypertable::SQLiteGen::Future get( SQLiteEnvPtr env );
+			Db::FuturePtr get( SQLiteEnvPtr env );
 
 			#endif
 
@@ -96,7 +96,7 @@ namespace ht4c { namespace SQLite {
 			};
 
 			SQLiteEnvPtr env;
-			//TODO Hypertable::SQLiteGen::Future future;
+			Db::FuturePtr future;
 			size_t capacity;
 			mutable bool cancelled;
 			mutable std::mutex mutex;
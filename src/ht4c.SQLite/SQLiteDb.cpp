@@ -28,22 +28,6 @@
 
 namespace ht4c { namespace SQLite { namespace Db {
 
-	namespace {
-
-		std::string escape( const std::string& s ) {
-			std::string escaped( s );
-			boost::replace_all( escaped, "'", "''" );
-			return escaped;
-		}
-
-		std::string escape( const char* s ) {
-			std::string escaped( s );
-			boost::replace_all( escaped, "'", "''" );
-			return escaped;
-		}
-
-	}
-
 	Client::Client( SQLiteEnvPtr _env )
 	: env( _env )
 	, db( _env->getDb() )
@@ -585,6 +569,26 @@ namespace ht4c { namespace SQLite { namespace Db {
 		return new Db::Scanner( this, scanSpec, flags );
 	}
 
+	Db::MutatorAsyncPtr Table::createMutatorAsync( Db::FuturePtr future, int32_t flags ) {
+		if( !id ) {
+			HT4C_SQLITE_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Invalid identifier for table '%s'", getFullName()).c_str() );
+		}
+		if( !db ) {
+			HT4C_SQLITE_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Table '%s' already disposed", getFullName()).c_str() );
+		}
+		return new Db::MutatorAsync( this, future, flags );
+	}
+
+	Db::ScannerAsyncPtr Table::createScannerAsync( const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags ) {
+		if( !id ) {
+			HT4C_SQLITE_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Invalid identifier for table '%s'", getFullName()).c_str() );
+		}
+		if( !db ) {
+			HT4C_SQLITE_THROW( Hypertable::Error::TABLE_NOT_FOUND, Hypertable::format("Table '%s' already disposed", getFullName()).c_str() );
+		}
+		return new Db::ScannerAsync( this, scanSpec, future, flags );
+	}
+
 	Hypertable::SchemaPtr Table::getSchema() {
 		if( !schema ) {
 			schema = Hypertable::SchemaPtr( Hypertable::Schema::new_instance(schemaSpec) );
@@ -651,10 +655,10 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 	void Table::open( ) {
 		dispose();
-		if( !env->sysDbOpenTable(this, id) ) {
+		if( !env->sysDbOpenTable(this, id, shard) ) {
 			HT4C_SQLITE_THROW( Hypertable::Error::HYPERSPACE_FILE_NOT_FOUND, Hypertable::format("Table '%s' does not exist", name.c_str()).c_str() );
 		}
-		db = env->getDb();
+		db = shard->getDb();
 	}
 
 	void Table::refresh( ) {
@@ -691,11 +695,14 @@ namespace ht4c { namespace SQLite { namespace Db {
 	: table( _table )
 	, flags( _flags )
 	, flushInterval( _flushInterval )
-	, db( _table->getEnv()->getDb() )
+	, lastFlush( ::GetTickCount64() )
+	, shard( _table->getShard() )
+	, db( _table->getShard()->getDb() )
 	, env( _table->getEnv() )
 	, schema( _table->getSchema().get() )
 	, dbReleaseMemory( false ) 
 	, stmtInsert( 0 )
+	, stmtInsertBatch( 0 )
 	, stmtDeleteRow( 0 )
 	, stmtDeleteCf( 0 )
 	, stmtDeleteCell( 0 )
@@ -710,6 +717,14 @@ namespace ht4c { namespace SQLite { namespace Db {
 		int st = sqlite3_prepare_v2( db, Hypertable::format("INSERT OR REPLACE INTO t%lld (r, cf, cq, ts, v) VALUES(?, ?, ?, ?, ?);", table->getId()).c_str(), -1, &stmtInsert, 0 );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
+		std::string insertBatch = Hypertable::format( "INSERT OR REPLACE INTO t%lld (r, cf, cq, ts, v) VALUES(?, ?, ?, ?, ?)", table->getId() );
+		for( int n = 1; n < BATCH_INSERT_ROWS; ++n ) {
+			insertBatch += ",(?, ?, ?, ?, ?)";
+		}
+		insertBatch += ";";
+		st = sqlite3_prepare_v3( db, insertBatch.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmtInsertBatch, 0 );
+		HT4C_SQLITE_VERIFY( st, db, 0 );
+
 		st = sqlite3_prepare_v2( db, Hypertable::format("DELETE FROM t%lld WHERE r=? AND ts>?;", table->getId()).c_str(), -1, &stmtDeleteRow, 0 );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
@@ -725,6 +740,7 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 	Mutator::~Mutator( ) {
 		Util::stmt_finalize( db, &stmtInsert );
+		Util::stmt_finalize( db, &stmtInsertBatch );
 		Util::stmt_finalize( db, &stmtDeleteRow );
 		Util::stmt_finalize( db, &stmtDeleteCf );
 		Util::stmt_finalize( db, &stmtDeleteCell );
@@ -736,6 +752,7 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 		schema = 0;
 		db = 0;
+		shard = 0;
 		table = 0;
 	}
 
@@ -748,15 +765,35 @@ namespace ht4c { namespace SQLite { namespace Db {
 	}
 
 	void Mutator::set( const Hypertable::Cells& cells ) {
-		for each( const Hypertable::Cell& cell in cells ) {
-			cell.sanity_check();
-
-			Hypertable::Key key;
-			toKey( schema
-					 , cell
-					 , key );
-
-			set( key, cell.value, cell.value_len );
+		// consecutive inserts are written through the multi-row insert, deletes apply in order
+		pending.reserve( std::min(cells.size(), static_cast<size_t>(BATCH_INSERT_ROWS)) );
+		try {
+			for each( const Hypertable::Cell& cell in cells ) {
+				cell.sanity_check();
+
+				PendingInsert pendingInsert;
+				toKey( schema
+						 , cell
+						 , pendingInsert.key );
+
+				if( pendingInsert.key.flag == Hypertable::FLAG_INSERT ) {
+					pendingInsert.value = cell.value;
+					pendingInsert.valueLength = cell.value_len;
+					pending.push_back( pendingInsert );
+					if( pending.size() == BATCH_INSERT_ROWS ) {
+						insertPending( );
+					}
+				}
+				else {
+					insertPending( );
+					del( pendingInsert.key );
+				}
+			}
+			insertPending( );
+		}
+		catch( ... ) {
+			pending.clear();
+			throw;
 		}
 	}
 
@@ -774,35 +811,74 @@ namespace ht4c { namespace SQLite { namespace Db {
 	}
 
 	void Mutator::flush( ) {
-		env->txCommit();
+		shard->txFlush( this );
+		lastFlush = ::GetTickCount64();
 	}
 
 	void Mutator::insert( Hypertable::Key& key, const void* value, uint32_t valueLength ) {
-		env->txBegin();
+		shard->txBegin();
 
 		Util::StmtReset stmt( stmtInsert );
+		bindInsert( stmtInsert, 1, key, value, valueLength );
 
-		int st = sqlite3_bind_text( stmtInsert, 1, key.row, key.row_len, 0 );
+		int st = sqlite3_step( stmtInsert );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
-		st = sqlite3_bind_int( stmtInsert, 2, key.column_family_code );
-		HT4C_SQLITE_VERIFY( st, db, 0 );
+		if( !dbReleaseMemory ) {
+			dbReleaseMemory = valueLength >= HUGE_VALUE_LENGTH;
+		}
+
+		written( 1, key.row_len + key.column_qualifier_len + valueLength );
+	}
 
-		st = sqlite3_bind_text( stmtInsert, 3, Util::CQ(key.column_qualifier), key.column_qualifier_len, 0 );
+	void Mutator::insertPending( ) {
+		if( pending.size() == BATCH_INSERT_ROWS ) {
+			shard->txBegin();
+
+			size_t size = 0;
+			{
+				Util::StmtReset stmt( stmtInsertBatch );
+				int index = 1;
+				for each( const PendingInsert& pendingInsert in pending ) {
+					bindInsert( stmtInsertBatch, index, pendingInsert.key, pendingInsert.value, pendingInsert.valueLength );
+					index += 5;
+					size += pendingInsert.key.row_len + pendingInsert.key.column_qualifier_len + pendingInsert.valueLength;
+
+					if( !dbReleaseMemory ) {
+						dbReleaseMemory = pendingInsert.valueLength >= HUGE_VALUE_LENGTH;
+					}
+				}
+
+				int st = sqlite3_step( stmtInsertBatch );
+				HT4C_SQLITE_VERIFY( st, db, 0 );
+			}
+
+			pending.clear();
+			written( BATCH_INSERT_ROWS, size );
+		}
+		else {
+			for( std::vector<PendingInsert>::iterator it = pending.begin(); it != pending.end(); ++it ) {
+				insert( (*it).key, (*it).value, (*it).valueLength );
+			}
+			pending.clear();
+		}
+	}
+
+	void Mutator::bindInsert( sqlite3_stmt* stmt, int index, const Hypertable::Key& key, const void* value, uint32_t valueLength ) {
+		int st = sqlite3_bind_text( stmt, index, key.row, key.row_len, 0 );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
-		st = sqlite3_bind_int64( stmtInsert, 4, timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp );
+		st = sqlite3_bind_int( stmt, index + 1, key.column_family_code );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
-		st = sqlite3_bind_blob( stmtInsert, 5, value, valueLength, 0 );
+		st = sqlite3_bind_text( stmt, index + 2, Util::CQ(key.column_qualifier), key.column_qualifier_len, 0 );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
-		st = sqlite3_step( stmtInsert );
+		st = sqlite3_bind_int64( stmt, index + 3, timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
 
-		if( !dbReleaseMemory ) {
-			dbReleaseMemory = valueLength >= HUGE_VALUE_LENGTH;
-		}
+		st = sqlite3_bind_blob( stmt, index + 4, value, valueLength, 0 );
+		HT4C_SQLITE_VERIFY( st, db, 0 );
 	}
 
 	void Mutator::toKey( Hypertable::Schema* schema
@@ -858,7 +934,7 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 		int64_t timestamp = timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp;
 
-		env->txBegin();
+		shard->txBegin();
 
 		switch( key.flag ) {
 			case Hypertable::FLAG_DELETE_ROW: {
@@ -932,29 +1008,88 @@ namespace ht4c { namespace SQLite { namespace Db {
 				break;
 			}
 		}
+
+		written( 1, key.row_len + key.column_qualifier_len );
 	}
 
-	MutatorAsync::MutatorAsync( Db::TablePtr _table )
-	: table( _table )
-	, db( _table->getEnv()->getDb() )
-	, schema( _table->getSchema().get() ) {
+	void Mutator::written( int cells, size_t size ) {
+		shard->txWritten( this, cells, size );
+
+		if( flushInterval > 0 && ::GetTickCount64() - lastFlush >= static_cast<ULONGLONG>(flushInterval) ) {
+			flush();
+		}
+	}
+
+	MutatorAsync::MutatorAsync( Db::TablePtr _table, Db::FuturePtr future, int32_t flags )
+	: Common::MutatorAsync( future )
+	, table( _table )
+	, mutator( _table->createMutator(flags, 0) )
+	{
 	}
 
 	MutatorAsync::~MutatorAsync( ) {
-		schema = 0;
-		db = 0;
+		mutator = 0;
 		table = 0;
 	}
 
+	void MutatorAsync::write( const Hypertable::Cells& cells ) {
+		HT4C_TRY {
+			SQLiteShardLock sync( mutator->getShard() );
+			mutator->set( cells );
+		}
+		HT4C_SQLITE_RETHROW
+	}
+
+	void MutatorAsync::flushWritten( ) {
+		SQLiteShardLock sync( mutator->getShard() );
+		mutator->flush();
+	}
+
 	Scanner::Scanner( Db::TablePtr _table, const Hypertable::ScanSpec& _scanSpec, uint32_t _flags )
 	: table( _table )
 	, flags( _flags )
-	, db( _table->getEnv()->getDb() )
+	, shard( _table->getShard() )
+	, db( _table->getShard()->acquireReader() )
+	, pooled( db != 0 )
+	, reader( 0 )
 	, scanSpec( _scanSpec )
 	{
+		if( !pooled ) {
+			db = shard->getDb();
+		}
+
+		try {
+			createReader( );
+			reader->stmtPrepare( );
+		}
+		catch( ... ) {
+			if( reader ) {
+				delete reader;
+				reader = 0;
+			}
+			if( pooled ) {
+				shard->releaseReader( db );
+			}
+			throw;
+		}
+	}
+
+	Scanner::~Scanner( ) {
+		if( reader ) {
+			delete reader;
+			reader = 0;
+		}
+		if( pooled ) {
+			shard->releaseReader( db );
+		}
+		db = 0;
+		shard = 0;
+	}
+
+	void Scanner::createReader( ) {
 		if( scanSpec.get().row_intervals.empty() ) {
 			if( scanSpec.get().cell_intervals.empty() ) {
-				reader = new Reader( _table.get(), db, scanSpec.get() );
+				reader = new Reader( table.get(), db, scanSpec.get() );
 			}
 			else {
 				Hypertable::CellIntervals& cellIntervals = scanSpec.get().cell_intervals;
@@ -966,11 +1101,11 @@ namespace ht4c { namespace SQLite { namespace Db {
 						ci->end_row = Hypertable::Key::END_ROW_MARKER;
 					}
 				}
-				reader = new ReaderCellIntervals( _table.get(), db, scanSpec.get() );
+				reader = new ReaderCellIntervals( table.get(), db, scanSpec.get() );
 			}
 		}
 		else if (scanSpec.get().scan_and_filter_rows) {
-			reader = new ReaderScanAndFilter( _table.get(), db, scanSpec.get() );
+			reader = new ReaderScanAndFilter( table.get(), db, scanSpec.get() );
 		}
 		else {
 			Hypertable::RowIntervals& rowIntervals = scanSpec.get().row_intervals;
@@ -983,24 +1118,28 @@ namespace ht4c { namespace SQLite { namespace Db {
 				}
 			}
 
-			reader = new ReaderRowIntervals( _table.get(), db, scanSpec.get() );
+			reader = new ReaderRowIntervals( table.get(), db, scanSpec.get() );
 		}
-
-		reader->stmtPrepare( );
-	}
-
-	Scanner::~Scanner( ) {
-		if( reader ) {
-			delete reader;
-			reader = 0;
-		}
-		db = 0;
 	}
 
 	bool Scanner::nextCell( Hypertable::Cell& cell ) {
 		return reader->nextCell( cell );
 	}
 
+	bool Scanner::nextCells( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size ) {
+		size = 0;
+		// cells refer to the statement's column buffers, copy them once into the builder's arena
+		Hypertable::Cell cell;
+		for( uint32_t count = 0; count < maxCells && size < maxBytes; ++count ) {
+			if( !reader->nextCell(cell) ) {
+				return false;
+			}
+			cells.add( cell, true );
+			size += static_cast<uint32_t>( Util::CellSize(cell) );
+		}
+		return true;
+	}
+
 	Scanner::ScanContext::ScanContext( const Hypertable::ScanSpec& _scanSpec, Hypertable::SchemaPtr _schema )
 	: Common::ScanContext( _scanSpec, _schema )
 	{
@@ -1024,14 +1163,18 @@ namespace ht4c { namespace SQLite { namespace Db {
 			}
 		}
 
+		// the predicate is parameterised, params are in the order of the placeholders
 		std::string predicateTimestamp;
+		params.clear();
 		if( timeInterval.first > Hypertable::TIMESTAMP_MIN ) {
 			if( hasTimeOrderAsc != hasTimeOrderDesc ) {
 				if( hasTimeOrderAsc ) {
-					predicateTimestamp = Hypertable::format( "ts<=%lld", ~timeInterval.first );
+					predicateTimestamp = "ts<=?";
+					params.push_back( intParam(~timeInterval.first) );
 				}
 				else {
-					predicateTimestamp = Hypertable::format( "ts>=%lld", timeInterval.first );
+					predicateTimestamp = "ts>=?";
+					params.push_back( intParam(timeInterval.first) );
 				}
 			}
 		}
@@ -1039,10 +1182,12 @@ namespace ht4c { namespace SQLite { namespace Db {
 		if( timeInterval.second < Hypertable::TIMESTAMP_MAX ) {
 			if( hasTimeOrderAsc != hasTimeOrderDesc ) {
 				if( hasTimeOrderAsc ) {
-					predicateTimestamp += Hypertable::format( "%sts>%lld", predicateTimestamp.empty() ? "" : " AND ",  ~timeInterval.second );
+					predicateTimestamp += Hypertable::format( "%sts>?", predicateTimestamp.empty() ? "" : " AND " );
+					params.push_back( intParam(~timeInterval.second) );
 				}
 				else {
-					predicateTimestamp += Hypertable::format( "%sts<%lld", predicateTimestamp.empty() ? "" : " AND ",  timeInterval.second );
+					predicateTimestamp += Hypertable::format( "%sts<?", predicateTimestamp.empty() ? "" : " AND " );
+					params.push_back( intParam(timeInterval.second) );
 				}
 			}
 		}
@@ -1055,11 +1200,65 @@ namespace ht4c { namespace SQLite { namespace Db {
 		else {
 			predicate = qPredicate;
 		}
+		params.insert( params.end(), cfParams.begin(), cfParams.end() );
+		params.insert( params.end(), qParams.begin(), qParams.end() );
 
 		if( !predicateTimestamp.empty() ) {
 			predicate = predicate.empty() ? predicateTimestamp : Hypertable::format( "%s AND (%s)", predicateTimestamp.c_str(), predicate.c_str() );
 		}
 
+		// value predicates, evaluated by the query so that non-matching rows never get materialised
+		std::string predicateValue;
+		std::map<int, std::pair<std::string, std::vector<Param>>> columnPredicates;
+		for each( const Hypertable::ColumnPredicate& cp in scanSpec.column_predicates ) {
+			if( cp.column_family && *cp.column_family && (cp.operation & Hypertable::ColumnPredicate::VALUE_MATCH) ) {
+				// column family has already been verified
+				std::pair<std::string, std::vector<Param>>& cpp = columnPredicates[schema->get_column_family(cp.column_family)->get_id()];
+				if( !cpp.first.empty() ) {
+					cpp.first += " OR ";
+				}
+
+				// Hypertable cannot distinguish between NULL and ""
+				if( cp.value ) {
+					switch( cp.operation ) {
+						case Hypertable::ColumnPredicate::EXACT_MATCH:
+							cpp.first += "ifnull(v,x'')=?";
+							cpp.second.push_back( blobParam(cp.value, cp.value_len) );
+							continue;
+						case Hypertable::ColumnPredicate::PREFIX_MATCH:
+							cpp.first += "substr(ifnull(v,x''),1,?)=?";
+							cpp.second.push_back( intParam(cp.value_len) );
+							cpp.second.push_back( blobParam(cp.value, cp.value_len) );
+							continue;
+						case Hypertable::ColumnPredicate::REGEX_MATCH:
+							cpp.first += "ifnull(v,x'') REGEXP ?";
+							cpp.second.push_back( textParam(std::string(reinterpret_cast<const char*>(cp.value), cp.value_len)) );
+							continue;
+						default:
+							break;
+					}
+				}
+				cpp.first += "0";
+			}
+		}
+
+		std::vector<Param> valueParams;
+		for( std::map<int, std::pair<std::string, std::vector<Param>>>::const_iterator it = columnPredicates.begin(); it != columnPredicates.end(); ++it ) {
+			predicateValue += Hypertable::format( "%s(cf<>? OR %s)", predicateValue.empty() ? "" : " AND ", (*it).second.first.c_str() );
+			valueParams.push_back( intParam((*it).first) );
+			valueParams.insert( valueParams.end(), (*it).second.second.begin(), (*it).second.second.end() );
+		}
+
+		if( valueRegexp ) {
+			predicateValue += Hypertable::format( "%sifnull(v,x'') REGEXP ?", predicateValue.empty() ? "" : " AND " );
+			valueParams.push_back( textParam(scanSpec.value_regexp) );
+		}
+
+		if( !predicateValue.empty() ) {
+			predicate = predicate.empty() ? predicateValue : Hypertable::format( "(%s) AND %s", predicate.c_str(), predicateValue.c_str() );
+			params.insert( params.end(), valueParams.begin(), valueParams.end() );
+		}
+
 		columns = "r, cf, cq, ts";
 		if( !keysOnly ) {
 			columns += ", v";
@@ -1067,17 +1266,67 @@ namespace ht4c { namespace SQLite { namespace Db {
 	}
 
 	void Scanner::ScanContext::initialColumn( Hypertable::ColumnFamilySpec* cf, bool hasQualifier, bool isRegexp, bool isPrefix, const std::string& qualifier ) {
-		if( !hasQualifier || isRegexp ) {
-			cfPredicate += Hypertable::format( "%s'%d'", cfPredicate.empty() ? "" : ",", cf->get_id() );
+		if( !hasQualifier ) {
+			cfPredicate += cfPredicate.empty() ? "?" : ",?";
+			cfParams.push_back( intParam(cf->get_id()) );
+		}
+		else if( isRegexp ) {
+			qPredicate += Hypertable::format( "%s(cf=? AND cq REGEXP ?)", qPredicate.empty() ? "" : " OR " );
+			qParams.push_back( intParam(cf->get_id()) );
+			qParams.push_back( textParam(qualifier) );
 		}
 		else if (isPrefix) {
-			qPredicate += Hypertable::format( "%s(cf=%d AND cq>=%s)", qPredicate.empty() ? "" : " OR ", cf->get_id(), escape(qualifier).c_str() );
+			// prefix range, the upper bound is the prefix with its last byte incremented
+			std::string upper( qualifier );
+			while( !upper.empty() && static_cast<uint8_t>(*upper.rbegin()) == 0xff ) {
+				upper.erase( upper.size() - 1 );
+			}
+			if( !upper.empty() ) {
+				++(*upper.rbegin());
+				qPredicate += Hypertable::format( "%s(cf=? AND cq>=? AND cq<?)", qPredicate.empty() ? "" : " OR " );
+				qParams.push_back( intParam(cf->get_id()) );
+				qParams.push_back( textParam(qualifier) );
+				qParams.push_back( textParam(upper) );
+			}
+			else {
+				qPredicate += Hypertable::format( "%s(cf=? AND cq>=?)", qPredicate.empty() ? "" : " OR " );
+				qParams.push_back( intParam(cf->get_id()) );
+				qParams.push_back( textParam(qualifier) );
+			}
 		}
 		else {
-			qPredicate += Hypertable::format( "%s(cf=%d AND cq='%s')", qPredicate.empty() ? "" : " OR ", cf->get_id(), escape(qualifier).c_str() );
+			qPredicate += Hypertable::format( "%s(cf=? AND cq=?)", qPredicate.empty() ? "" : " OR " );
+			qParams.push_back( intParam(cf->get_id()) );
+			qParams.push_back( textParam(qualifier) );
 		}
 	}
 
+	Scanner::ScanContext::Param Scanner::ScanContext::intParam( int64_t value ) {
+		Param param;
+		param.value = value;
+		param.isText = false;
+		param.isBlob = false;
+		return param;
+	}
+
+	Scanner::ScanContext::Param Scanner::ScanContext::textParam( const std::string& text ) {
+		Param param;
+		param.value = 0;
+		param.text = text;
+		param.isText = true;
+		param.isBlob = false;
+		return param;
+	}
+
+	Scanner::ScanContext::Param Scanner::ScanContext::blobParam( const void* value, uint32_t len ) {
+		Param param;
+		param.value = 0;
+		param.text.assign( reinterpret_cast<const char*>(value), len );
+		param.isText = false;
+		param.isBlob = true;
+		return param;
+	}
+
 	Scanner::Reader::Reader( Db::Table* table, sqlite3* _db, const Hypertable::ScanSpec& scanSpec )
 	: env( table->getEnv() )
 	, db( _db )
@@ -1093,23 +1342,13 @@ namespace ht4c { namespace SQLite { namespace Db {
 	, cellCount( 0 )
 	, cellPerFamilyCount( 0 )
 	, noCellRevisions( table->NoCellRevisions() )
-	, stmtDeleteCf( 0 )
 	, eos( false )
 	{
-		bool ttl = false;
 		scanContext->initialize();
 		memset( timeOrderAsc, true, sizeof(timeOrderAsc) );
 		const Hypertable::ColumnFamilySpecs& families = scanContext->schema->get_column_families();
 		for each( const Hypertable::ColumnFamilySpec* cf in families ) {
 			timeOrderAsc[cf->get_id()] = !cf->get_option_time_order_desc();
-			if( cf->get_option_ttl() != 0 ) {
-				ttl = true;
-			}
-		}
-
-		if( ttl ) {
-			int st = sqlite3_prepare_v2( db, Hypertable::format("DELETE FROM t%lld WHERE r=? AND cf=? AND ts>?;", tableId).c_str(), -1, &stmtDeleteCf, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
 		}
 	}
 
@@ -1117,10 +1356,7 @@ namespace ht4c { namespace SQLite { namespace Db {
 		delete scanContext;
 		scanContext = 0;
 
-		Util::stmt_finalize( db, &stmtQuery );
-		if( stmtDeleteCf ) {
-			Util::stmt_finalize( db, &stmtDeleteCf );
-		}
+		stmtRelease( );
 		db = 0;
 	}
 
@@ -1147,17 +1383,58 @@ namespace ht4c { namespace SQLite { namespace Db {
 	}
 
 	void Scanner::Reader::stmtPrepare( ) {
-		Util::stmt_finalize( db, &stmtQuery );
-
 		std::string predicate;
 		if( !scanContext->predicate.empty() ) {
 			predicate = " WHERE " + scanContext->predicate;
 		}
 
 		const char* orderBy = noCellRevisions ? "ORDER BY r, cf, cq" : "ORDER BY r, cf, cq, ts";
-		std::string select = Hypertable::format( "SELECT %s FROM t%lld%s %s;", scanContext->columns.c_str(), tableId, predicate.c_str(), orderBy );
-		int st = sqlite3_prepare_v2( db, select.c_str(), -1, &stmtQuery, 0 );
+		stmtAcquire( Hypertable::format("SELECT %s FROM t%lld%s %s;", scanContext->columns.c_str(), tableId, predicate.c_str(), orderBy) );
+		bindPredicate( 1 );
+	}
+
+	void Scanner::Reader::stmtAcquire( const std::string& sql ) {
+		// same query shape, rebind the current statement
+		if( stmtQuery && sql == stmtSql ) {
+			sqlite3_reset( stmtQuery );
+			sqlite3_clear_bindings( stmtQuery );
+			return;
+		}
+
+		stmtRelease( );
+		stmtQuery = env->stmtAcquire( db, tableId, sql );
+		stmtSql = sql;
+	}
+
+	void Scanner::Reader::stmtRelease( ) {
+		if( stmtQuery ) {
+			env->stmtRelease( db, tableId, stmtSql, stmtQuery );
+			stmtQuery = 0;
+		}
+	}
+
+	int Scanner::Reader::bindText( int index, const char* text ) {
+		int st = sqlite3_bind_text( stmtQuery, index, text, -1, 0 );
 		HT4C_SQLITE_VERIFY( st, db, 0 );
+		return index + 1;
+	}
+
+	int Scanner::Reader::bindInt( int index, int value ) {
+		int st = sqlite3_bind_int( stmtQuery, index, value );
+		HT4C_SQLITE_VERIFY( st, db, 0 );
+		return index + 1;
+	}
+
+	void Scanner::Reader::bindPredicate( int index ) {
+		for each( const ScanContext::Param& param in scanContext->params ) {
+			int st = param.isText
+						 ? sqlite3_bind_text( stmtQuery, index++, param.text.c_str(), static_cast<int>(param.text.size()), 0 )
+						 : param.isBlob
+						 ? sqlite3_bind_blob( stmtQuery, index++, param.text.data(), static_cast<int>(param.text.size()), 0 )
+						 : sqlite3_bind_int64( stmtQuery, index++, param.value );
+
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+		}
 	}
 
 	bool Scanner::Reader::moveNext( ) {
@@ -1201,22 +1478,8 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 		CellFilterInfo& cfi = scanContext->familyInfo[key.column_family_code];
 
-		// cutoff time
+		// cutoff time, expired cells get purged in the background
 		if( key.timestamp < cfi.cutoffTime ) {
-			Util::StmtReset stmt( stmtDeleteCf );
-
-			int st = sqlite3_bind_text( stmtDeleteCf, 1, key.row, key.row_len, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-
-			st = sqlite3_bind_int( stmtDeleteCf, 2, key.column_family_code );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-
-			st = sqlite3_bind_int64( stmtDeleteCf, 3, timeOrderAsc[key.column_family_code] ? ~key.timestamp : key.timestamp );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-
-			st = sqlite3_step( stmtDeleteCf );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-
 			return 0;
 		}
 
@@ -1288,14 +1551,11 @@ namespace ht4c { namespace SQLite { namespace Db {
 	}
 
 	bool Scanner::Reader::getCell( const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell ) {
-		if( !scanContext->valueRegexp ) {
-			if( !checkCellLimits(key) ) {
-				return false;
-			}
+		// column predicates and the value regexp have already been applied by the query
+		if( !checkCellLimits(key) ) {
+			return false;
 		}
 
-		CellFilterInfo& cfi = scanContext->familyInfo[key.column_family_code];
-
 		cell.row_key = key.row;
 		cell.column_family = cf.get_name().c_str();
 		cell.column_qualifier = key.column_qualifier;
@@ -1305,32 +1565,9 @@ namespace ht4c { namespace SQLite { namespace Db {
 		cell.value = 0;
 		cell.value_len = 0;
 
-		if( !scanContext->keysOnly || scanContext->valueRegexp ) {
-			const void* v = sqlite3_column_blob( stmtQuery, 4 );
-			uint32_t len = sqlite3_column_bytes( stmtQuery, 4 );
-
-			// filter by column predicate
-			if( cfi.hasColumnPredicateFilter() ) {
-				if( !cfi.columnPredicateMatches(reinterpret_cast<const char*>(v), len) ) {
-					return false;
-				}
-			}
-
-			// filter by value regexp
-			if( scanContext->valueRegexp ) {
-				if( !RE2::PartialMatch(re2::StringPiece(reinterpret_cast<const char*>(v), len), *(scanContext->valueRegexp)) ) {
-					return false;
-				}
-
-				if( !checkCellLimits(key) ) {
-					return false;
-				}
-			}
-
-			if( !scanContext->keysOnly ) {
-				cell.value = reinterpret_cast<const uint8_t*>( v );
-				cell.value_len = len;
-			}
+		if( !scanContext->keysOnly ) {
+			cell.value = reinterpret_cast<const uint8_t*>( sqlite3_column_blob(stmtQuery, 4) );
+			cell.value_len = sqlite3_column_bytes( stmtQuery, 4 );
 		}
 
 		return true;
@@ -1372,7 +1609,6 @@ namespace ht4c { namespace SQLite { namespace Db {
 	}
 
 	void Scanner::ReaderScanAndFilter::stmtPrepare( ) {
-		Util::stmt_finalize( db, &stmtQuery );
 		std::string predicate;
 		if( !scanContext->predicate.empty() ) {
 			predicate = " AND (" + scanContext->predicate + ")";
@@ -1380,26 +1616,27 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 		const char* orderBy = noCellRevisions ? "ORDER BY r, cf, cq" : "ORDER BY r, cf, cq, ts";
 
-		std::string select;
+		int index = 1;
 		if( strcmp(*scanContext->rowset.begin(),*scanContext->rowset.rbegin()) ) {
-			select = Hypertable::format( "SELECT %s FROM t%lld WHERE (r>='%s' AND r <='%s')%s %s;"
-																	, scanContext->columns.c_str()
-																	, tableId
-																	, escape(*scanContext->rowset.begin()).c_str()
-																	, escape(*scanContext->rowset.rbegin()).c_str()
-																	, predicate.c_str()
-																	, orderBy );
+			stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE (r>=? AND r <=?)%s %s;"
+																		, scanContext->columns.c_str()
+																		, tableId
+																		, predicate.c_str()
+																		, orderBy) );
+
+			index = bindText( index, *scanContext->rowset.begin() );
+			index = bindText( index, *scanContext->rowset.rbegin() );
 		}
 		else {
-			select = Hypertable::format( "SELECT %s FROM t%lld WHERE r='%s'%s %s;"
-																	, scanContext->columns.c_str()
-																	, tableId
-																	, escape(*scanContext->rowset.begin()).c_str()
-																	, predicate.c_str()
-																	, orderBy );
+			stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE r=?%s %s;"
+																		, scanContext->columns.c_str()
+																		, tableId
+																		, predicate.c_str()
+																		, orderBy) );
+
+			index = bindText( index, *scanContext->rowset.begin() );
 		}
-		int st = sqlite3_prepare_v2( db, select.c_str(), -1, &stmtQuery, 0 );
-		HT4C_SQLITE_VERIFY( st, db, 0 )
+		bindPredicate( index );
 	}
 
 	Scanner::ReaderRowIntervals::ReaderRowIntervals( Db::Table* table, sqlite3* db, const Hypertable::ScanSpec& _scanSpec )
@@ -1427,7 +1664,6 @@ namespace ht4c { namespace SQLite { namespace Db {
 			cellCount = 0;
 			cellPerFamilyCount = 0;
 
-			Util::stmt_finalize( db, &stmtQuery );
 			std::string predicate;
 			if( !scanContext->predicate.empty() ) {
 				predicate = " AND (" + scanContext->predicate + ")";
@@ -1435,48 +1671,52 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 			const char* orderBy = noCellRevisions ? "ORDER BY r, cf, cq" : "ORDER BY r, cf, cq, ts";
 
-			std::string select;
+			// row bounds are bound, the statement gets reused for all intervals of the same shape
+			int index = 1;
 			if( strcmp(it->start, it->end) ) {
 				if( *it->start && *it->end ) {
-					select = Hypertable::format( "SELECT %s FROM t%lld WHERE (r>%s'%s' AND r <%s'%s')%s %s;"
-																		 , scanContext->columns.c_str()
-																		 , tableId
-																		 , it->start_inclusive ? "=" : ""
-																		 , escape(it->start).c_str()
-																		 , it->end_inclusive ? "=" : ""
-																		 , escape(it->end).c_str()
-																		 , predicate.c_str()
-																		 , orderBy );
+					stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE (r>%s? AND r <%s?)%s %s;"
+																				, scanContext->columns.c_str()
+																				, tableId
+																				, it->start_inclusive ? "=" : ""
+																				, it->end_inclusive ? "=" : ""
+																				, predicate.c_str()
+																				, orderBy) );
+
+					index = bindText( index, it->start );
+					index = bindText( index, it->end );
 				}
 				else if( *it->end ) {
-					select = Hypertable::format( "SELECT %s FROM t%lld WHERE (r <%s'%s')%s %s;"
+					stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE (r <%s?)%s %s;"
 						, scanContext->columns.c_str()
 						, tableId
 						, it->end_inclusive ? "=" : ""
-						, escape(it->end).c_str()
 						, predicate.c_str()
-						, orderBy );
+						, orderBy) );
+
+					index = bindText( index, it->end );
 				}
 				else {
-					select = Hypertable::format( "SELECT %s FROM t%lld WHERE (r>%s'%s')%s %s;"
+					stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE (r>%s?)%s %s;"
 						, scanContext->columns.c_str()
 						, tableId
 						, it->start_inclusive ? "=" : ""
-						, escape(it->start).c_str()
 						, predicate.c_str()
-						, orderBy );
+						, orderBy) );
+
+					index = bindText( index, it->start );
 				}
 			}
 			else {
-				select = Hypertable::format( "SELECT %s FROM t%lld WHERE r='%s'%s %s;"
-																	 , scanContext->columns.c_str()
-																	 , tableId
-																	 , escape((*it).start).c_str()
-																	 , predicate.c_str()
-																	 , orderBy );
+				stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE r=?%s %s;"
+																			, scanContext->columns.c_str()
+																			, tableId
+																			, predicate.c_str()
+																			, orderBy) );
+
+				index = bindText( index, (*it).start );
 			}
-			st = sqlite3_prepare_v2( db, select.c_str(), -1, &stmtQuery, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 )
+			bindPredicate( index );
 		}
 
 		st = sqlite3_step( stmtQuery );
@@ -1551,7 +1791,6 @@ namespace ht4c { namespace SQLite { namespace Db {
 			endColumnFamilyCode = cf->get_id();
 			endColumnQualifier = hasQualifier && !isRegexp ? endColumnQualifierBuf.c_str() : 0;
 
-			Util::stmt_finalize( db, &stmtQuery );
 			std::string predicate;
 			if( !scanContext->predicate.empty() ) {
 				predicate = " AND (" + scanContext->predicate + ")";
@@ -1559,37 +1798,40 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 			const char* orderBy = noCellRevisions ? "ORDER BY r, cf, cq" : "ORDER BY r, cf, cq, ts";
 
-			std::string select;
+			// row and column family bounds are bound, the statement gets reused for all intervals of the same shape
+			int index = 1;
 			if( strcmp(it->start_row, it->end_row) ) {
-				select = Hypertable::format( "SELECT %s FROM t%lld WHERE (r>='%s' AND r <='%s')%s %s;"
-																	 , scanContext->columns.c_str()
-																	 , tableId
-																	 , escape(it->start_row).c_str()
-																	 , escape(it->end_row).c_str()
-																	 , predicate.c_str()
-																	 , orderBy );
+				stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE (r>=? AND r <=?)%s %s;"
+																			, scanContext->columns.c_str()
+																			, tableId
+																			, predicate.c_str()
+																			, orderBy) );
+
+				index = bindText( index, it->start_row );
+				index = bindText( index, it->end_row );
 			}
 			else if( startColumnFamilyCode != endColumnFamilyCode ) {
-				select = Hypertable::format( "SELECT %s FROM t%lld WHERE r='%s' AND cf>=%d AND cf<=%d%s %s;"
-																	 , scanContext->columns.c_str()
-																	 , tableId
-																	 , escape((*it).start_row).c_str()
-																	 , startColumnFamilyCode
-																	 , endColumnFamilyCode
-																	 , predicate.c_str()
-																	 , orderBy );
+				stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE r=? AND cf>=? AND cf<=?%s %s;"
+																			, scanContext->columns.c_str()
+																			, tableId
+																			, predicate.c_str()
+																			, orderBy) );
+
+				index = bindText( index, (*it).start_row );
+				index = bindInt( index, startColumnFamilyCode );
+				index = bindInt( index, endColumnFamilyCode );
 			}
 			else {
-				select = Hypertable::format( "SELECT %s FROM t%lld WHERE r='%s' AND cf=%d%s %s;"
-																	 , scanContext->columns.c_str()
-																	 , tableId
-																	 , escape((*it).start_row).c_str()
-																	 , startColumnFamilyCode
-																	 , predicate.c_str()
-																	 , orderBy );
+				stmtAcquire( Hypertable::format("SELECT %s FROM t%lld WHERE r=? AND cf=?%s %s;"
+																			, scanContext->columns.c_str()
+																			, tableId
+																			, predicate.c_str()
+																			, orderBy) );
+
+				index = bindText( index, (*it).start_row );
+				index = bindInt( index, startColumnFamilyCode );
 			}
-			st = sqlite3_prepare_v2( db, select.c_str(), -1, &stmtQuery, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 )
+			bindPredicate( index );
 		}
 
 		st = sqlite3_step( stmtQuery );
@@ -1639,14 +1881,29 @@ namespace ht4c { namespace SQLite { namespace Db {
 		return 0;
 	}
 
-	ScannerAsync::ScannerAsync( Db::TablePtr _table )
-	: table( _table )
-	, db( _table->getEnv()->getDb() ) {
+	ScannerAsync::ScannerAsync( Db::TablePtr _table, const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags )
+	: Common::ScannerAsync( future )
+	, table( _table )
+	, scanner( _table->createScanner(scanSpec, flags) )
+	{
 	}
 
 	ScannerAsync::~ScannerAsync( ) {
-		db = 0;
+		scanner = 0;
 		table = 0;
 	}
 
+	bool ScannerAsync::read( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size ) {
+		HT4C_TRY {
+			// A pooled read connection steps without the shard lock, a scanner
+			// sharing the writer connection holds it for one batch only
+			if( scanner->isPooled() ) {
+				return scanner->nextCells( cells, maxCells, maxBytes, size );
+			}
+			SQLiteShardLock sync( scanner->getShard() );
+			return scanner->nextCells( cells, maxCells, maxBytes, size );
+		}
+		HT4C_SQLITE_RETHROW
+	}
+
 } } }
\ No newline at end of file
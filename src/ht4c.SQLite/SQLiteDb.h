@@ -27,6 +27,7 @@
 
 #include "sqlite3.h"
 #include "SQLiteEnv.h"
+#include "ht4c.Common/Future.h"
 
 namespace ht4c { namespace SQLite { namespace Db {
 
@@ -57,6 +58,9 @@ namespace ht4c { namespace SQLite { namespace Db {
 	class ScannerAsync;
 	typedef boost::intrusive_ptr<ScannerAsync> ScannerAsyncPtr;
 
+	typedef Common::Future Future;
+	typedef Common::FuturePtr FuturePtr;
+
 	struct NamespaceListing {
 		std::string name;
 		bool isNamespace;
@@ -70,6 +74,7 @@ namespace ht4c { namespace SQLite { namespace Db {
 		};
 
 		const char NamespaceListing = '0';
+		const char ShardPlacement = '1';
 
 	}
 
@@ -155,6 +160,9 @@ namespace ht4c { namespace SQLite { namespace Db {
 			inline SQLiteEnv* getEnv( ) const {
 				return ns->getEnv();
 			}
+			inline SQLiteShard* getShard( ) const {
+				return shard.get();
+			}
 			inline NamespacePtr getNamespace( ) {
 				return ns;
 			}
@@ -168,6 +176,8 @@ namespace ht4c { namespace SQLite { namespace Db {
 			void getTableSchema( bool withIds, std::string& schema );
 			Db::MutatorPtr createMutator( int32_t flags, int32_t flushInterval );
 			Db::ScannerPtr createScanner( const Hypertable::ScanSpec& scanSpec, uint32_t flags );
+			Db::MutatorAsyncPtr createMutatorAsync( Db::FuturePtr future, int32_t flags );
+			Db::ScannerAsyncPtr createScannerAsync( const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags );
 			Hypertable::SchemaPtr getSchema( );
 			bool nameExists( bool& isTable, int64_t* rowid = 0 );
 			inline int64_t getId( ) const {
@@ -192,6 +202,7 @@ namespace ht4c { namespace SQLite { namespace Db {
 			int64_t id;
 			sqlite3* db;
 			SQLiteEnv* env;
+			SQLiteShardPtr shard;
 			bool uniqueRows;
 			bool noCellRevisions;
 	};
@@ -206,6 +217,9 @@ namespace ht4c { namespace SQLite { namespace Db {
 			inline SQLiteEnv* getEnv( ) const {
 				return table->getEnv();
 			}
+			inline SQLiteShard* getShard( ) const {
+				return shard.get();
+			}
 			void set( Hypertable::KeySpec& keySpec, const void* value, uint32_t valueLength );
 			void set( const Hypertable::Cells& cells );
 			void del( Hypertable::KeySpec& keySpec );
@@ -214,6 +228,8 @@ namespace ht4c { namespace SQLite { namespace Db {
 		private:
 
 			void insert( Hypertable::Key& key, const void* value, uint32_t valueLength );
+			void insertPending( );
+			void bindInsert( sqlite3_stmt* stmt, int index, const Hypertable::Key& key, const void* value, uint32_t valueLength );
 			void set( Hypertable::Key& key, const void* value, uint32_t valueLength );
 			void del( Hypertable::Key& key );
 			void toKey( Hypertable::Schema* schema
@@ -259,9 +275,13 @@ namespace ht4c { namespace SQLite { namespace Db {
 						 , fullKey );
 			}
 
+			void written( int cells, size_t size );
+
 			Db::TablePtr table;
 			int32_t flags;
 			int32_t flushInterval;
+			ULONGLONG lastFlush;
+			SQLiteShardPtr shard;
 			sqlite3* db;
 			SQLiteEnv* env;
 			Hypertable::Schema* schema;
@@ -274,33 +294,47 @@ namespace ht4c { namespace SQLite { namespace Db {
 			};
 			bool timeOrderAsc[MAX_CF];
 
+			struct PendingInsert {
+				Hypertable::Key key;
+				const void* value;
+				uint32_t valueLength;
+			};
+			std::vector<PendingInsert> pending;
+			enum {
+				BATCH_INSERT_ROWS = 64
+			};
+
 			sqlite3_stmt* stmtBegin;
 			sqlite3_stmt* stmtCommit;
 			sqlite3_stmt* stmtRollback;
 			sqlite3_stmt* stmtInsert;
+			sqlite3_stmt* stmtInsertBatch;
 			sqlite3_stmt* stmtDeleteRow;
 			sqlite3_stmt* stmtDeleteCf;
 			sqlite3_stmt* stmtDeleteCell;
 			sqlite3_stmt* stmtDeleteCellVersion;
 	};
 
-	class MutatorAsync : public Hypertable::ReferenceCount {
+	class MutatorAsync : public Common::MutatorAsync {
 
 		public:
 
-			explicit MutatorAsync( Db::TablePtr table );
+			MutatorAsync( Db::TablePtr table, Db::FuturePtr future, int32_t flags );
 			virtual ~MutatorAsync( );
 
 			inline SQLiteEnv* getEnv( ) const {
 				return table->getEnv();
 			}
-			inline void flush( ) { }
+
+		protected:
+
+			virtual void write( const Hypertable::Cells& cells );
+			virtual void flushWritten( );
 
 		private:
 
 			Db::TablePtr table;
-			sqlite3* db;
-			Hypertable::Schema* schema;
+			Db::MutatorPtr mutator;
 	};
 
 	class Scanner : public Hypertable::ReferenceCount {
@@ -313,7 +347,14 @@ namespace ht4c { namespace SQLite { namespace Db {
 			inline SQLiteEnv* getEnv( ) const {
 				return table->getEnv();
 			}
+			inline SQLiteShard* getShard( ) const {
+				return shard.get();
+			}
 			bool nextCell( Hypertable::Cell& cell );
+			inline bool isPooled( ) const {
+				return pooled;
+			}
+			bool nextCells( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size );
 
 		private:
 
@@ -327,14 +368,30 @@ namespace ht4c { namespace SQLite { namespace Db {
 					ScanContext( const Hypertable::ScanSpec& scanSpec, Hypertable::SchemaPtr schema );
 					virtual void initialize( );
 
+					struct Param {
+						int64_t value;
+						std::string text;
+						bool isText;
+						bool isBlob;
+					};
+
 					std::string predicate;
 					std::string cfPredicate;
 					std::string qPredicate;
 					std::string columns;
+					std::vector<Param> params;
+					std::vector<Param> cfParams;
+					std::vector<Param> qParams;
 
 			protected:
 
 				virtual void initialColumn( Hypertable::ColumnFamilySpec* cf, bool hasQualifier, bool isRegexp, bool isPrefix, const std::string& qualifier );
+
+			private:
+
+				static Param intParam( int64_t value );
+				static Param textParam( const std::string& text );
+				static Param blobParam( const void* value, uint32_t len );
 			};
 
 			class Reader {
@@ -356,11 +413,17 @@ namespace ht4c { namespace SQLite { namespace Db {
 						eos = true;
 					}
 					bool getCell( const Hypertable::Key& key, const Hypertable::ColumnFamilySpec& cf, Hypertable::Cell& cell );
+					void stmtAcquire( const std::string& sql );
+					void stmtRelease( );
+					int bindText( int index, const char* text );
+					int bindInt( int index, int value );
+					void bindPredicate( int index );
 
 					SQLiteEnv* env;
 					sqlite3* db;
 					int64_t tableId;
 					sqlite3_stmt* stmtQuery;
+					std::string stmtSql;
 					ScanContext* scanContext;
 					int rowCount;
 					int cellCount;
@@ -375,7 +438,6 @@ namespace ht4c { namespace SQLite { namespace Db {
 
 					bool checkCellLimits( const Hypertable::Key& key );
 
-					sqlite3_stmt* stmtDeleteCf;
 					Hypertable::DynamicBuffer currkey;
 					Hypertable::DynamicBuffer prevKey;
 					int prevColumnFamilyCode;
@@ -452,28 +514,36 @@ namespace ht4c { namespace SQLite { namespace Db {
 					bool cellIntervalDone;
 			};
 
+			void createReader( );
+
 			Db::TablePtr table;
 			int32_t flags;
+			SQLiteShardPtr shard;
 			sqlite3* db;
+			bool pooled;
 			Reader* reader;
 			Hypertable::ScanSpecBuilder scanSpec;
 	};
 
-	class ScannerAsync : public Hypertable::ReferenceCount {
+	class ScannerAsync : public Common::ScannerAsync {
 
 		public:
 
-			explicit ScannerAsync( Db::TablePtr table );
+			ScannerAsync( Db::TablePtr table, const Hypertable::ScanSpec& scanSpec, Db::FuturePtr future, uint32_t flags );
 			virtual ~ScannerAsync( );
 
 			inline SQLiteEnv* getEnv( ) const {
 				return table->getEnv();
 			}
 
+		protected:
+
+			virtual bool read( Hypertable::CellsBuilder& cells, uint32_t maxCells, uint32_t maxBytes, uint32_t& size );
+
 		private:
 
 			Db::TablePtr table;
-			sqlite3* db;
+			Db::ScannerPtr scanner;
 	};
 
 } } }
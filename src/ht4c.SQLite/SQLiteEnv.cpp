@@ -32,67 +32,362 @@
 namespace ht4c { namespace SQLite {
 	using namespace Db;
 
-	SQLiteEnv::SQLiteEnv( const std::string &filename, const SQLiteEnvConfig& config )
-	: db( 0 )
+	SQLiteShard::SQLiteShard( const std::string& _filename, const SQLiteEnvConfig& config )
+	: filename( _filename )
+	, db( 0 )
 	, readOnly( false )
+	, dropped( false )
+	, autoVacuum( config.autoVacuum )
 	, tx( false )
-	, autoVacuum( autoVacuum )
+	, txCells( 0 )
+	, txBytes( 0 )
+	, txStart( 0 )
+	, commitCells( std::max(0, config.commitCells) )
+	, commitBytes( static_cast<size_t>(std::max(0, config.commitSizeMB)) * 1024 * 1024 )
+	, commitInterval( std::max(0, config.commitIntervalMsec) )
+	, groupCommit( config.groupCommit && config.commitIntervalMsec > 0 )
+	, mmapSize( static_cast<int64_t>(std::max(0, config.mmapSizeMB)) * 1024 * 1024 )
+	, maxReaders( 0 )
+	, readers( 0 )
+	, stmtBegin( 0 )
+	, stmtCommit( 0 )
+	, stmtRollback( 0 )
+	{
+		::InitializeCriticalSection( &cs );
+		::InitializeCriticalSection( &csReaders );
+		try {
+			int st = sqlite3_open( filename.c_str(), &db );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+
+			readOnly = sqlite3_db_readonly(db, "main") == 1;
+
+			st = SQLiteEnv::registerFunctions( db );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+
+			// WAL allows readers on separate connections to run in parallel with the writer
+			if( config.writeAheadLog && !readOnly && filename != ":memory:" ) {
+				maxReaders = std::max( 0, config.readConnections );
+			}
+
+			char* errmsg = 0;
+			if( !readOnly ) {
+				st = sqlite3_exec(db
+					, Hypertable::format(
+						"PRAGMA page_size=%d;"
+						"PRAGMA cache_size=%d;"
+						"PRAGMA journal_mode=%s;"
+						"PRAGMA synchronous=%s;"
+						"PRAGMA temp_store=MEMORY;"
+						"PRAGMA auto_vacuum=%d;"
+						"PRAGMA wal_autocheckpoint=%d;"
+						, std::max(1, std::min(config.pageSizeKB, 64)) * 1024
+						, std::max(1, 1024 * config.cacheSizeMB / config.pageSizeKB)
+						, config.writeAheadLog ? "WAL" : "TRUNCATE"
+						, config.synchronous ? "NORMAL" : "OFF"
+						, config.autoVacuum
+						, std::max(0, config.walAutoCheckpoint)).c_str()
+					, 0, 0, &errmsg);
+
+					HT4C_SQLITE_VERIFY(st, db, errmsg);
+			}
+
+			st = sqlite3_exec(db
+				, Hypertable::format(
+					"PRAGMA mmap_size=%lld;"
+					"PRAGMA cache_spill=%d;"
+					, mmapSize
+					, config.cacheSpill ? 1 : 0).c_str()
+				, 0, 0, &errmsg);
+
+			HT4C_SQLITE_VERIFY(st, db, errmsg);
+
+			prepareTx( );
+		}
+		catch( ... ) {
+			finalizeTx( );
+			if( db ) {
+				sqlite3_close( db );
+				db = 0;
+			}
+			::DeleteCriticalSection( &csReaders );
+			::DeleteCriticalSection( &cs );
+			throw;
+		}
+	}
+
+	SQLiteShard::~SQLiteShard( ) {
+		try {
+			close( );
+		}
+		catch( ... ) {
+		}
+		::DeleteCriticalSection( &csReaders );
+		::DeleteCriticalSection( &cs );
+	}
+
+	sqlite3* SQLiteShard::acquireReader( ) {
+		if( !maxReaders || !db ) {
+			return 0;
+		}
+
+		sqlite3* reader = 0;
+		bool open = false;
+		::EnterCriticalSection( &csReaders );
+		if( !readerPool.empty() ) {
+			reader = readerPool.back();
+			readerPool.pop_back();
+		}
+		else if( readers < maxReaders ) {
+			++readers;
+			open = true;
+		}
+		::LeaveCriticalSection( &csReaders );
+
+		if( open ) {
+			// private cache, a shared cache connection would share the writer's table locks
+			int st = sqlite3_open_v2( filename.c_str(), &reader, SQLITE_OPEN_READONLY|SQLITE_OPEN_PRIVATECACHE, 0 );
+			if( st == SQLITE_OK ) {
+				st = SQLiteEnv::registerFunctions( reader );
+			}
+			if( st == SQLITE_OK ) {
+				sqlite3_busy_timeout( reader, 5000 );
+				if( mmapSize ) {
+					sqlite3_exec( reader, Hypertable::format("PRAGMA mmap_size=%lld;", mmapSize).c_str(), 0, 0, 0 );
+				}
+			}
+			else {
+				sqlite3_close( reader );
+				reader = 0;
+
+				::EnterCriticalSection( &csReaders );
+				--readers;
+				::LeaveCriticalSection( &csReaders );
+			}
+		}
+
+		// The reader stays in autocommit mode, a query holds its WAL snapshot until it
+		// has been stepped to completion or reset, i.e. per statement or interval only,
+		// an explicit transaction would pin the WAL for the scanner's lifetime
+		return reader;
+	}
+
+	void SQLiteShard::releaseReader( sqlite3* reader ) {
+		if( reader ) {
+			if( !sqlite3_get_autocommit(reader) ) {
+				sqlite3_exec( reader, "ROLLBACK;", 0, 0, 0 );
+			}
+
+			::EnterCriticalSection( &csReaders );
+			readerPool.push_back( reader );
+			::LeaveCriticalSection( &csReaders );
+		}
+	}
+
+	void SQLiteShard::txBegin() {
+		if( !tx ) {
+			int st = sqlite3_step( stmtBegin );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+			tx = true;
+			txCells = 0;
+			txBytes = 0;
+			txStart = ::GetTickCount64();
+		}
+	}
+
+	void SQLiteShard::txCommit() {
+		if( tx ) {
+			int st = sqlite3_step( stmtCommit );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+			tx = false;
+			txWriters.clear();
+		}
+	}
+
+	void SQLiteShard::txRollback() {
+		if( tx ) {
+			int st = sqlite3_step( stmtRollback );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+			tx = false;
+			txWriters.clear();
+		}
+	}
+
+	void SQLiteShard::txWritten( const void* writer, int cells, size_t size ) {
+		if( tx ) {
+			txCells += cells;
+			txBytes += size;
+			txWriters.insert( writer );
+
+			// bounds the transaction and therefore the wal growth
+			if( (commitCells && txCells >= commitCells)
+				|| (commitBytes && txBytes >= commitBytes)
+				|| txExpired() ) {
+
+				txCommit();
+			}
+		}
+	}
+
+	void SQLiteShard::txFlush( const void* writer ) {
+		txWriters.erase( writer );
+
+		// group commit, defer the commit until the other writers have been flushed or the transaction expires,
+		// requires a commit interval otherwise a flush would wait for the other writers without bound
+		if( groupCommit && !txWriters.empty() && !txExpired() ) {
+			return;
+		}
+		txCommit();
+	}
+
+	void SQLiteShard::txCommitExpired( ) {
+		if( txCells && txExpired() ) {
+			txCommit();
+		}
+	}
+
+	bool SQLiteShard::txExpired( ) const {
+		return tx && commitInterval && ::GetTickCount64() - txStart >= commitInterval;
+	}
+
+	void SQLiteShard::dropTable( int64_t id ) {
+		// finalize begin, commit and rollback otherwise the table might be locked
+		finalizeTx( );
+
+		char* errmsg = 0;
+		int dropped = sqlite3_exec( db, Hypertable::format("DROP TABLE t%lld;", id).c_str(), 0, 0, &errmsg );
+
+		// .. and prepare again
+		prepareTx( );
+
+		HT4C_SQLITE_VERIFY( dropped, db, errmsg );
+	}
+
+	void SQLiteShard::drop( ) {
+		// the file gets deleted as soon as the last mutator or scanner has released the shard
+		dropped = true;
+	}
+
+	void SQLiteShard::close( ) {
+		for each( sqlite3* reader in readerPool ) {
+			sqlite3_close_v2( reader );
+		}
+		readerPool.clear();
+
+		if( db ) {
+			int st;
+			if( !dropped ) {
+				// commits mutations deferred by the commit policy
+				txCommit();
+			}
+			finalizeTx( );
+
+			if( !readOnly && !dropped ) {
+				char* errmsg = 0;
+				// incremental vacuum ?
+				if( autoVacuum == 2 ) {
+					// deletes the journal
+					st = sqlite3_exec(
+						db,
+						"PRAGMA incremental_vacuum;"
+						"PRAGMA optimize;"
+						"PRAGMA journal_mode=DELETE;"
+						"BEGIN;COMMIT;"
+						, 0, 0, &errmsg);
+				}
+				else {
+					// deletes the journal
+					st = sqlite3_exec(
+						db,
+						"PRAGMA optimize;"
+						"PRAGMA journal_mode=DELETE;"
+						"BEGIN;COMMIT;"
+						, 0, 0, &errmsg);
+				}
+				if( st != SQLITE_OK ) {
+					sqlite3_close_v2( db );
+					db = 0;
+				}
+				HT4C_SQLITE_VERIFY(st, db, errmsg);
+			}
+
+			// statements still cached elsewhere keep the connection alive until finalized
+			st = sqlite3_close_v2( db );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+			db = 0;
+
+			if( dropped ) {
+				::DeleteFileA( filename.c_str() );
+				::DeleteFileA( (filename + "-wal").c_str() );
+				::DeleteFileA( (filename + "-shm").c_str() );
+				::DeleteFileA( (filename + "-journal").c_str() );
+			}
+		}
+	}
+
+	void SQLiteShard::prepareTx( ) {
+		int st = sqlite3_prepare_v2( db, "BEGIN;", -1, &stmtBegin, 0 );
+		HT4C_SQLITE_VERIFY( st, db, 0 );
+
+		st = sqlite3_prepare_v2( db, "COMMIT;", -1, &stmtCommit, 0 );
+		HT4C_SQLITE_VERIFY( st, db, 0 );
+
+		st = sqlite3_prepare_v2( db, "ROLLBACK;", -1, &stmtRollback, 0 );
+		HT4C_SQLITE_VERIFY( st, db, 0 );
+	}
+
+	void SQLiteShard::finalizeTx( ) {
+		Util::stmt_finalize( db, &stmtBegin );
+		Util::stmt_finalize( db, &stmtCommit );
+		Util::stmt_finalize( db, &stmtRollback );
+	}
+
+	SQLiteEnv::SQLiteEnv( const std::string &_filename, const SQLiteEnvConfig& config )
+	: db( 0 )
+	, readOnly( false )
+	, commitTimer( 0 )
+	, checkpointDb( 0 )
+	, checkpointTimer( 0 )
+	, purgeBatchCells( std::max(1, config.purgeBatchCells) )
+	, purgeVersions( config.purgeVersions )
+	, purgeTimer( 0 )
+	, purging( 0 )
 	, uniqueRows( config.uniqueRows )
 	, noCellRevisions( config.noCellRevisions )
+	, withoutRowId( config.withoutRowId )
+	, shardPerTable( config.shardPerTable && _filename != "memory" )
 	, indexColumn( config.indexColumn )
 	, indexColumnFamily( config.indexColumnFamily )
 	, indexColumnQualifier( config.indexColumnQualifier )
 	, indexTimestamp( config.indexTimestamp )
-	, stmtBegin( 0 )
-	, stmtCommit( 0 )
-	, stmtRollback( 0 )
 	, stmtInsert( 0 )
 	, stmtUpdateKey( 0 )
 	, stmtUpdateValue( 0 )
 	, stmtFind( 0 )
 	, stmtRead( 0 )
 	, stmtDelete( 0 )
+	, filename( _filename == "memory" ? ":memory:" : _filename )
+	, shardConfig( new SQLiteEnvConfig(config) )
 	{
 		::InitializeCriticalSection( &cs );
+		::InitializeCriticalSection( &csStmtCache );
 		HT4C_TRY {
 			try {
 				sqlite3_enable_shared_cache( 1 );
-				int st = sqlite3_open( filename == "memory" ? ":memory:" : filename.c_str(), &db );
-				HT4C_SQLITE_VERIFY( st, db, 0 );
-
-				readOnly = sqlite3_db_readonly(db, "main") == 1;
+				main = new SQLiteShard( filename, config );
+				db = main->getDb();
+				readOnly = main->isReadOnly();
 
+				int st;
 				char* errmsg = 0;
 				if( !readOnly ) {
 					st = sqlite3_exec(db
-						, Hypertable::format(
-							"PRAGMA page_size=%d;"
-							"PRAGMA cache_size=%d;"
-							"PRAGMA journal_mode=%s;"
-							"PRAGMA synchronous=%s;"
-							"PRAGMA temp_store=MEMORY;"
-							"PRAGMA auto_vacuum=%d;"
-							"CREATE TABLE IF NOT EXISTS "
+						, "CREATE TABLE IF NOT EXISTS "
 							"sys_db (id INTEGER PRIMARY KEY AUTOINCREMENT, k TEXT NOT NULL, v BLOB, UNIQUE(k));"
-							, std::max(1, std::min(config.pageSizeKB, 64)) * 1024
-							, std::max(1, 1024 * config.cacheSizeMB / config.pageSizeKB)
-							, config.writeAheadLog ? "WAL" : "TRUNCATE"
-							, config.synchronous ? "NORMAL" : "OFF"
-							, config.autoVacuum).c_str()
 						, 0, 0, &errmsg);
 
 						HT4C_SQLITE_VERIFY(st, db, errmsg);
 				}
 
-				st = sqlite3_prepare_v2( db, "BEGIN;", -1, &stmtBegin, 0 );
-				HT4C_SQLITE_VERIFY( st, db, 0 );
-
-				st = sqlite3_prepare_v2( db, "COMMIT;", -1, &stmtCommit, 0 );
-				HT4C_SQLITE_VERIFY( st, db, 0 );
-
-				st = sqlite3_prepare_v2( db, "ROLLBACK;", -1, &stmtRollback, 0 );
-				HT4C_SQLITE_VERIFY( st, db, 0 );
-
 				st = sqlite3_prepare_v2( db, "INSERT INTO sys_db (k, v) VALUES(?, ?);", -1, &stmtInsert, 0 );
 				HT4C_SQLITE_VERIFY( st, db, 0 );
 
@@ -110,12 +405,61 @@ namespace ht4c { namespace SQLite {
 
 				st = sqlite3_prepare_v2( db, "DELETE FROM sys_db WHERE k=?;", -1, &stmtDelete, 0 );
 				HT4C_SQLITE_VERIFY( st, db, 0 );
+
+				// commits pending mutations of idle mutators
+				if( !readOnly && config.commitIntervalMsec > 0 ) {
+					DWORD interval = config.commitIntervalMsec;
+					if( !::CreateTimerQueueTimer(&commitTimer, 0, commitTimerProc, this, interval, interval, WT_EXECUTEDEFAULT) ) {
+						commitTimer = 0;
+					}
+				}
+
+				// passive checkpoints on a separate connection, do not stall the writer
+				if( config.writeAheadLog && !readOnly && _filename != "memory" && config.checkpointIntervalMsec > 0 ) {
+					st = sqlite3_open_v2( filename.c_str(), &checkpointDb, SQLITE_OPEN_READWRITE|SQLITE_OPEN_PRIVATECACHE, 0 );
+					HT4C_SQLITE_VERIFY( st, checkpointDb, 0 );
+
+					DWORD interval = config.checkpointIntervalMsec;
+					if( !::CreateTimerQueueTimer(&checkpointTimer, 0, checkpointTimerProc, this, interval, interval, WT_EXECUTELONGFUNCTION) ) {
+						checkpointTimer = 0;
+						sqlite3_close( checkpointDb );
+						checkpointDb = 0;
+					}
+				}
+
+				// purges expired cells and exceeding cell versions in the background, scanners just skip them
+				if( !readOnly && config.purgeIntervalMsec > 0 ) {
+					DWORD interval = config.purgeIntervalMsec;
+					if( !::CreateTimerQueueTimer(&purgeTimer, 0, purgeTimerProc, this, interval, interval, WT_EXECUTELONGFUNCTION) ) {
+						purgeTimer = 0;
+					}
+				}
 			}
 			catch( ... ) {
-				if( db ) {
-					sqlite3_close( db );
-					db = 0;
+				if( purgeTimer ) {
+					::DeleteTimerQueueTimer( 0, purgeTimer, INVALID_HANDLE_VALUE );
+					purgeTimer = 0;
+				}
+				if( commitTimer ) {
+					::DeleteTimerQueueTimer( 0, commitTimer, INVALID_HANDLE_VALUE );
+					commitTimer = 0;
+				}
+				if( checkpointTimer ) {
+					::DeleteTimerQueueTimer( 0, checkpointTimer, INVALID_HANDLE_VALUE );
+					checkpointTimer = 0;
 				}
+				if( checkpointDb ) {
+					sqlite3_close( checkpointDb );
+					checkpointDb = 0;
+				}
+				Util::stmt_finalize( db, &stmtInsert );
+				Util::stmt_finalize( db, &stmtUpdateKey );
+				Util::stmt_finalize( db, &stmtUpdateValue );
+				Util::stmt_finalize( db, &stmtFind );
+				Util::stmt_finalize( db, &stmtRead );
+				Util::stmt_finalize( db, &stmtDelete );
+				main = 0;
+				db = 0;
 				throw;
 			}
 		}
@@ -123,6 +467,36 @@ namespace ht4c { namespace SQLite {
 	}
 
 	SQLiteEnv::~SQLiteEnv( ) {
+		if( purgeTimer ) {
+			// waits for a running purge to complete
+			::DeleteTimerQueueTimer( 0, purgeTimer, INVALID_HANDLE_VALUE );
+			purgeTimer = 0;
+		}
+		if( commitTimer ) {
+			// waits for a running commit to complete
+			::DeleteTimerQueueTimer( 0, commitTimer, INVALID_HANDLE_VALUE );
+			commitTimer = 0;
+		}
+		if( checkpointTimer ) {
+			// waits for a running checkpoint to complete
+			::DeleteTimerQueueTimer( 0, checkpointTimer, INVALID_HANDLE_VALUE );
+			checkpointTimer = 0;
+		}
+		if( checkpointDb ) {
+			sqlite3_close( checkpointDb );
+			checkpointDb = 0;
+		}
+
+		for( stmt_cache_t::iterator it = stmtCache.begin(); it != stmtCache.end(); ++it ) {
+			for( stmts_t::iterator its = (*it).second.begin(); its != (*it).second.end(); ++its ) {
+				for each( sqlite3_stmt* stmt in (*its).second ) {
+					sqlite3_finalize( stmt );
+				}
+			}
+		}
+		stmtCache.clear();
+
+		::DeleteCriticalSection( &csStmtCache );
 		::DeleteCriticalSection( &cs );
 		HT4C_TRY {
 			for( tables_t::iterator it = tables.begin(); it != tables.end(); ++it ) {
@@ -133,9 +507,11 @@ namespace ht4c { namespace SQLite {
 			}
 			tables.clear();
 
-			Util::stmt_finalize( db, &stmtBegin );
-			Util::stmt_finalize( db, &stmtCommit );
-			Util::stmt_finalize( db, &stmtRollback );
+			for( shards_t::iterator it = shards.begin(); it != shards.end(); ++it ) {
+				(*it).second->close();
+			}
+			shards.clear();
+
 			Util::stmt_finalize( db, &stmtInsert );
 			Util::stmt_finalize( db, &stmtUpdateKey );
 			Util::stmt_finalize( db, &stmtUpdateValue );
@@ -143,37 +519,10 @@ namespace ht4c { namespace SQLite {
 			Util::stmt_finalize( db, &stmtRead );
 			Util::stmt_finalize( db, &stmtDelete );
 
-			if( db ) {
-				int st;
-				if( !readOnly ) {
-					// deletes the journal
-					char* errmsg = 0;
-					// incremental vacuum ?
-					if( autoVacuum == 2 ) {
-						// deletes the journal
-						st = sqlite3_exec(
-							db,
-							"PRAGMA incremental_vacuum;"
-							"PRAGMA optimize;"
-							"PRAGMA journal_mode=DELETE;"
-							"BEGIN;COMMIT;"
-							, 0, 0, &errmsg);
-					}
-					else {
-						char* errmsg = 0;
-						st = sqlite3_exec(
-							db,
-							"PRAGMA optimize;"
-							"PRAGMA journal_mode=DELETE;"
-							"BEGIN;COMMIT;"
-							, 0, 0, &errmsg);
-					}
-					HT4C_SQLITE_VERIFY(st, db, errmsg);
-				}
-
-				st = sqlite3_close( db );
-				HT4C_SQLITE_VERIFY( st, db, 0 );
+			if( main ) {
 				db = 0;
+				main->close();
+				main = 0;
 			}
 		}
 		HT4C_SQLITE_RETHROW
@@ -186,30 +535,322 @@ namespace ht4c { namespace SQLite {
 		HT4C_SQLITE_RETHROW
 	}
 
-	void SQLiteEnv::txBegin() {
-		if( !tx ) {
-			int st = sqlite3_step( stmtBegin );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-			tx = true;
+	sqlite3_stmt* SQLiteEnv::stmtAcquire( sqlite3* _db, int64_t tableId, const std::string& sql ) {
+		sqlite3_stmt* stmt = 0;
+		::EnterCriticalSection( &csStmtCache );
+		stmt_cache_t::iterator it = stmtCache.find( _db );
+		if( it != stmtCache.end() ) {
+			stmts_t::iterator its = (*it).second.find( std::make_pair(tableId, sql) );
+			if( its != (*it).second.end() && !(*its).second.empty() ) {
+				stmt = (*its).second.back();
+				(*its).second.pop_back();
+			}
+		}
+		::LeaveCriticalSection( &csStmtCache );
+
+		if( !stmt ) {
+			int st = sqlite3_prepare_v3( _db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, 0 );
+			HT4C_SQLITE_VERIFY( st, _db, 0 );
 		}
+		return stmt;
 	}
 
-	void SQLiteEnv::txCommit() {
-		if( tx ) {
-			int st = sqlite3_step( stmtCommit );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-			tx = false;
+	void SQLiteEnv::stmtRelease( sqlite3* _db, int64_t tableId, const std::string& sql, sqlite3_stmt* stmt ) {
+		if( stmt ) {
+			sqlite3_reset( stmt );
+			sqlite3_clear_bindings( stmt );
+
+			::EnterCriticalSection( &csStmtCache );
+			std::vector<sqlite3_stmt*>& stmts = stmtCache[_db][std::make_pair(tableId, sql)];
+			if( stmts.size() < MAX_CACHED_STMTS ) {
+				stmts.push_back( stmt );
+				stmt = 0;
+			}
+			::LeaveCriticalSection( &csStmtCache );
+
+			if( stmt ) {
+				sqlite3_finalize( stmt );
+			}
 		}
 	}
 
+	void SQLiteEnv::stmtPurge( int64_t tableId ) {
+		::EnterCriticalSection( &csStmtCache );
+		for( stmt_cache_t::iterator it = stmtCache.begin(); it != stmtCache.end(); ++it ) {
+			stmts_t& stmts = (*it).second;
+			stmts_t::iterator first = stmts.lower_bound( std::make_pair(tableId, std::string()) );
+			stmts_t::iterator last = stmts.lower_bound( std::make_pair(tableId + 1, std::string()) );
+			for( stmts_t::iterator its = first; its != last; ++its ) {
+				for each( sqlite3_stmt* stmt in (*its).second ) {
+					sqlite3_finalize( stmt );
+				}
+			}
+			stmts.erase( first, last );
+		}
+		::LeaveCriticalSection( &csStmtCache );
+	}
+
+	void SQLiteEnv::txBegin() {
+		main->txBegin();
+	}
+
+	void SQLiteEnv::txCommit() {
+		main->txCommit();
+	}
+
 	void SQLiteEnv::txRollback() {
-		if( tx ) {
-			int st = sqlite3_step( stmtRollback );
+		main->txRollback();
+	}
+
+	SQLiteShardPtr SQLiteEnv::shardOf( int64_t id ) {
+		shards_t::const_iterator it = shards.find( id );
+		if( it != shards.end() ) {
+			return (*it).second;
+		}
+
+		// not opened yet, the placement record tells whether the table has a dedicated file
+		std::string placement = shardKey( id );
+		Hypertable::DynamicBuffer shardFilename;
+		if( sysDbRead(placement.c_str(), static_cast<int>(placement.size() + 1), shardFilename, 0) ) {
+			SQLiteShardPtr shard = new SQLiteShard( reinterpret_cast<const char*>(shardFilename.base), *shardConfig );
+			shards[id] = shard;
+			return shard;
+		}
+		return main;
+	}
+
+	std::string SQLiteEnv::shardKey( int64_t id ) const {
+		std::string key;
+		key += KeyClassifiers::ShardPlacement;
+		key += Hypertable::format( "%lld", id );
+		return key;
+	}
+
+	VOID CALLBACK SQLiteEnv::checkpointTimerProc( void* param, BOOLEAN /*timerOrWaitFired*/ ) {
+		SQLiteEnv* env = reinterpret_cast<SQLiteEnv*>( param );
+		sqlite3_wal_checkpoint_v2( env->checkpointDb, 0, SQLITE_CHECKPOINT_PASSIVE, 0, 0 );
+	}
+
+	void SQLiteEnv::purge( ) {
+		// snapshot of the table schemas, the lock is held per purge transaction only
+		struct PurgeTable {
+			int64_t id;
+			std::string schemaSpec;
+			SQLiteShardPtr shard;
+		};
+		std::vector<PurgeTable> purgeTables;
+		{
+			Lock sync( this );
+			sqlite3_stmt* stmt = 0;
+			Util::StmtFinalize finalize( db, &stmt );
+
+			int st = sqlite3_prepare_v2( db, Hypertable::format("SELECT id, v FROM sys_db WHERE substr(k,1,1)='%c' AND length(v)>0;", KeyClassifiers::NamespaceListing).c_str(), -1, &stmt, 0 );
+			HT4C_SQLITE_VERIFY( st, db, 0 );
+
+			while( (st = sqlite3_step(stmt)) == SQLITE_ROW ) {
+				PurgeTable entry;
+				entry.id = sqlite3_column_int64( stmt, 0 );
+				entry.schemaSpec = reinterpret_cast<const char*>( sqlite3_column_blob(stmt, 1) );
+				entry.shard = shardOf( entry.id );
+				purgeTables.push_back( entry );
+			}
 			HT4C_SQLITE_VERIFY( st, db, 0 );
-			tx = false;
+		}
+
+		std::set<SQLiteShard*> purged;
+		for each( const PurgeTable& entry in purgeTables ) {
+			try {
+				if( purgeTable(entry.shard.get(), entry.id, entry.schemaSpec) ) {
+					purged.insert( entry.shard.get() );
+				}
+			}
+			catch( ... ) {
+				// table might have been dropped in the meantime
+			}
+		}
+
+		// returns the freed pages to the file system
+		for each( const PurgeTable& entry in purgeTables ) {
+			SQLiteShard* shard = entry.shard.get();
+			if( purged.erase(shard) && shard->autoVacuum == 2 ) {
+				SQLiteShardLock sync( shard );
+				if( shard->getDb() && !shard->hasTx() ) {
+					char* errmsg = 0;
+					int st = sqlite3_exec( shard->getDb(), "PRAGMA incremental_vacuum;", 0, 0, &errmsg );
+					HT4C_SQLITE_VERIFY( st, shard->getDb(), errmsg );
+				}
+			}
 		}
 	}
 
+	bool SQLiteEnv::purgeTable( SQLiteShard* shard, int64_t id, const std::string& schemaSpec ) {
+		Hypertable::SchemaPtr schema( Hypertable::Schema::new_instance(schemaSpec) );
+		int64_t now = Hypertable::get_ts64();
+
+		// cell key of the range deletes, unique and indexed in either table layout,
+		// the env-wide layout setting might not match the layout of an existing table
+		const char* columns = "r, cf, cq, ts";
+		const char* key = "(r, cf, cq, ts)";
+
+		bool purged = false;
+		bool indexed = false;
+		for each( const Hypertable::ColumnFamilySpec* cf in schema->get_column_families() ) {
+			if( cf->get_deleted() ) {
+				continue;
+			}
+
+			// timestamps are stored complemented for ascending time order
+			bool timeOrderAsc = !cf->get_option_time_order_desc();
+			if( cf->get_option_ttl() != 0 ) {
+				// the deletes seek by (cf, ts), without an index each batch scans the whole table,
+				// created on demand since a ttl might have been added by altering the table
+				if( !indexed ) {
+					SQLiteShardLock sync( shard );
+					sqlite3* db = shard->getDb();
+					if( !db || shard->hasTx() ) {
+						return purged;
+					}
+
+					char* errmsg = 0;
+					int st = sqlite3_exec( db, Hypertable::format("CREATE INDEX IF NOT EXISTS i_cfts ON t%lld (cf, ts);", id).c_str(), 0, 0, &errmsg );
+					HT4C_SQLITE_VERIFY( st, db, errmsg );
+					indexed = true;
+				}
+
+				int64_t cutoffTime = now - ((int64_t)cf->get_option_ttl() * 1000000000LL);
+				std::string sql = Hypertable::format( "DELETE FROM t%lld WHERE %s IN (SELECT %s FROM t%lld WHERE cf=?1 AND ts%c?2 LIMIT ?3);"
+																						, id, key, columns, id, timeOrderAsc ? '>' : '<' );
+
+				if( purgeCells(shard, sql, cf->get_id(), timeOrderAsc ? ~cutoffTime : cutoffTime) ) {
+					purged = true;
+				}
+			}
+
+			// cell versions are scanned in ts order, ranking the versions costs a pass over the
+			// column family per batch, hence opt-in
+			if( purgeVersions && cf->get_option_max_versions() != 0 && !uniqueRows && !noCellRevisions ) {
+				std::string sql = Hypertable::format( "DELETE FROM t%lld WHERE %s IN (SELECT %s FROM "
+																						"(SELECT %s, ROW_NUMBER() OVER (PARTITION BY r, cq ORDER BY ts) AS n FROM t%lld WHERE cf=?1) "
+																						"WHERE n>?2 LIMIT ?3);"
+																						, id, key, columns, columns, id );
+
+				if( purgeCells(shard, sql, cf->get_id(), cf->get_option_max_versions()) ) {
+					purged = true;
+				}
+			}
+		}
+
+		return purged;
+	}
+
+	bool SQLiteEnv::purgeCells( SQLiteShard* shard, const std::string& sql, int cf, int64_t ts ) {
+		int changes = 0;
+		for( bool more = true; more; ) {
+			{
+				SQLiteShardLock sync( shard );
+
+				// low priority, leave the writer connection to pending mutations
+				sqlite3* db = shard->getDb();
+				if( !db || shard->hasTx() ) {
+					break;
+				}
+
+				sqlite3_stmt* stmt = 0;
+				Util::StmtFinalize finalize( db, &stmt );
+
+				int st = sqlite3_prepare_v2( db, sql.c_str(), -1, &stmt, 0 );
+				HT4C_SQLITE_VERIFY( st, db, 0 );
+
+				st = sqlite3_bind_int( stmt, 1, cf );
+				HT4C_SQLITE_VERIFY( st, db, 0 );
+
+				st = sqlite3_bind_int64( stmt, 2, ts );
+				HT4C_SQLITE_VERIFY( st, db, 0 );
+
+				st = sqlite3_bind_int( stmt, 3, purgeBatchCells );
+				HT4C_SQLITE_VERIFY( st, db, 0 );
+
+				// one small transaction per batch
+				shard->txBegin();
+				try {
+					st = sqlite3_step( stmt );
+					HT4C_SQLITE_VERIFY( st, db, 0 );
+
+					int n = sqlite3_changes( db );
+					changes += n;
+					more = n >= purgeBatchCells;
+
+					shard->txCommit();
+				}
+				catch( ... ) {
+					shard->txRollback();
+					throw;
+				}
+			}
+
+			if( more ) {
+				::SwitchToThread();
+			}
+		}
+
+		return changes > 0;
+	}
+
+	VOID CALLBACK SQLiteEnv::purgeTimerProc( void* param, BOOLEAN /*timerOrWaitFired*/ ) {
+		SQLiteEnv* env = reinterpret_cast<SQLiteEnv*>( param );
+
+		// skips the period if the previous purge is still running
+		if( ::InterlockedCompareExchange(&env->purging, 1, 0) == 0 ) {
+			try {
+				env->purge();
+			}
+			catch( ... ) {
+			}
+			::InterlockedExchange( &env->purging, 0 );
+		}
+	}
+
+	VOID CALLBACK SQLiteEnv::commitTimerProc( void* param, BOOLEAN /*timerOrWaitFired*/ ) {
+		SQLiteEnv* env = reinterpret_cast<SQLiteEnv*>( param );
+		try {
+			Lock sync( env );
+			env->main->txCommitExpired();
+			for( shards_t::iterator it = env->shards.begin(); it != env->shards.end(); ++it ) {
+				SQLiteShardLock shardSync( (*it).second.get() );
+				(*it).second->txCommitExpired();
+			}
+		}
+		catch( ... ) {
+		}
+	}
+
+	int SQLiteEnv::registerFunctions( sqlite3* _db ) {
+		// X REGEXP Y, used by the scanners to push qualifier and value regexps into the query
+		return sqlite3_create_function_v2( _db, "regexp", 2, SQLITE_UTF8|SQLITE_DETERMINISTIC, 0, regexp, 0, 0, 0 );
+	}
+
+	void SQLiteEnv::regexp( sqlite3_context* ctx, int /*argc*/, sqlite3_value** argv ) {
+		// the compiled pattern is kept for the lifetime of the statement
+		re2::RE2* re = reinterpret_cast<re2::RE2*>( sqlite3_get_auxdata(ctx, 0) );
+		bool cached = re != 0;
+		if( !cached ) {
+			const char* pattern = reinterpret_cast<const char*>( sqlite3_value_text(argv[0]) );
+			re = new re2::RE2( re2::StringPiece(pattern ? pattern : "", sqlite3_value_bytes(argv[0])) );
+		}
+
+		const void* v = sqlite3_value_blob( argv[1] );
+		int len = sqlite3_value_bytes( argv[1] );
+		sqlite3_result_int( ctx, RE2::PartialMatch(re2::StringPiece(v ? reinterpret_cast<const char*>(v) : "", len), *re) ? 1 : 0 );
+
+		if( !cached ) {
+			sqlite3_set_auxdata( ctx, 0, re, regexpDelete );
+		}
+	}
+
+	void SQLiteEnv::regexpDelete( void* re ) {
+		delete reinterpret_cast<re2::RE2*>( re );
+	}
+
 	void SQLiteEnv::sysDbInsert( const char* name, int len, const void* value, int size, int64_t* rowid ) {
 		Util::StmtReset stmt( stmtInsert );
 
@@ -315,15 +956,36 @@ namespace ht4c { namespace SQLite {
 	void SQLiteEnv::sysDbCreateTable( const char* name, int len, const void* value, int size, int64_t& id ) {
 		sysDbInsert( name, len, value, size, &id );
 
-		const char* rowColumn = uniqueRows ? "r TEXT NOT NULL PRIMARY KEY" : "r TEXT NOT NULL";
-		const char* uniqueConstraint = noCellRevisions ? "UNIQUE(r, cf, cq)" : "UNIQUE(r, cf, cq, ts)";
+		// a dedicated database file per table, the placement is recorded in sys_db
+		SQLiteShardPtr shard = main;
+		if( shardPerTable ) {
+			std::string shardFilename = Hypertable::format( "%s.t%lld", filename.c_str(), id );
+			std::string key = shardKey( id );
+			sysDbInsert( key.c_str(), static_cast<int>(key.size() + 1), shardFilename.c_str(), static_cast<int>(shardFilename.size() + 1) );
+
+			shard = new SQLiteShard( shardFilename, *shardConfig );
+			shards[id] = shard;
+		}
+		sqlite3* db = shard->getDb();
+
+		std::string create;
+		if( withoutRowId ) {
+			// clustered in key order, the cells are stored once in the primary key btree
+			const char* primaryKey = uniqueRows ? "PRIMARY KEY(r)" : noCellRevisions ? "PRIMARY KEY(r, cf, cq)" : "PRIMARY KEY(r, cf, cq, ts)";
+			create = Hypertable::format( "CREATE TABLE IF NOT EXISTS "
+																	 "t%lld (r TEXT NOT NULL, cf INTEGER NOT NULL, cq TEXT NOT NULL, ts INTEGER NOT NULL, v BLOB,"
+																	 "%s) WITHOUT ROWID;", id, primaryKey );
+		}
+		else {
+			const char* rowColumn = uniqueRows ? "r TEXT NOT NULL PRIMARY KEY" : "r TEXT NOT NULL";
+			const char* uniqueConstraint = noCellRevisions ? "UNIQUE(r, cf, cq)" : "UNIQUE(r, cf, cq, ts)";
+			create = Hypertable::format( "CREATE TABLE IF NOT EXISTS "
+																	 "t%lld (%s, cf INTEGER NOT NULL, cq TEXT NOT NULL, ts INTEGER NOT NULL, v BLOB,"
+																	 "%s);", id, rowColumn, uniqueConstraint );
+		}
 
 		char* errmsg = 0;
-		int st = sqlite3_exec( db
-												 , Hypertable::format("CREATE TABLE IF NOT EXISTS "
-																							"t%lld (%s, cf INTEGER NOT NULL, cq TEXT NOT NULL, ts INTEGER NOT NULL, v BLOB,"
-																							"%s);", id, rowColumn, uniqueConstraint).c_str()
-												 , 0, 0, &errmsg );
+		int st = sqlite3_exec( db, create.c_str(), 0, 0, &errmsg );
 
 		HT4C_SQLITE_VERIFY( st, db, errmsg );
 
@@ -360,12 +1022,15 @@ namespace ht4c { namespace SQLite {
 		}
 	}
 
-	bool SQLiteEnv::sysDbOpenTable( Db::Table* table, int64_t& id ) {
+	bool SQLiteEnv::sysDbOpenTable( Db::Table* table, int64_t& id, SQLiteShardPtr& shard ) {
 		const char* key;
 		int len = table->toKey( key );
 		Hypertable::DynamicBuffer buf;
 		if( sysDbRead(key, len, buf, &id) ) {
 			table->fromRecord( buf );
+
+			shard = shardOf( id );
+
 			tables[id].insert( table );
 			return true;
 		}
@@ -408,25 +1073,23 @@ namespace ht4c { namespace SQLite {
 				tables.erase( id );
 			}
 
-			// finalize begin, commit and rollback otherwise the table might be locked
-			Util::stmt_finalize( db, &stmtBegin );
-			Util::stmt_finalize( db, &stmtCommit );
-			Util::stmt_finalize( db, &stmtRollback );
+			// finalize cached statements otherwise the table might be locked
+			stmtPurge( id );
 
-			char* errmsg = 0;
-			int dropped = sqlite3_exec( db, Hypertable::format("DROP TABLE t%d;", id).c_str(), 0, 0, &errmsg );
+			std::string placement = shardKey( id );
+			sysDbDelete( placement.c_str(), static_cast<int>(placement.size() + 1) );
 
-			// .. and prepare again
-			int st = sqlite3_prepare_v2( db, "BEGIN;", -1, &stmtBegin, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-
-			st = sqlite3_prepare_v2( db, "COMMIT;", -1, &stmtCommit, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
+			shards_t::iterator its = shards.find( id );
+			if( its != shards.end() ) {
+				SQLiteShardPtr shard = (*its).second;
+				shards.erase( its );
 
-			st = sqlite3_prepare_v2( db, "ROLLBACK;", -1, &stmtRollback, 0 );
-			HT4C_SQLITE_VERIFY( st, db, 0 );
-
-			HT4C_SQLITE_VERIFY( dropped, db, errmsg );
+				SQLiteShardLock sync( shard.get() );
+				shard->drop();
+			}
+			else {
+				main->dropTable( id );
+			}
 			return true;
 		}
 		return false;
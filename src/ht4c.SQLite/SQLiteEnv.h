@@ -27,6 +27,8 @@
 
 struct sqlite3;
 struct sqlite3_stmt;
+struct sqlite3_context;
+struct sqlite3_value;
 
 namespace ht4c { namespace Common {
 
@@ -44,6 +46,106 @@ namespace ht4c { namespace SQLite {
 
 	struct SQLiteEnvConfig;
 
+	/// <summary>
+	/// Represents a sqlite database file, its writer connection and pooled read connections.
+	/// </summary>
+	class SQLiteShard : public Hypertable::ReferenceCount {
+
+		public:
+
+			SQLiteShard( const std::string& filename, const SQLiteEnvConfig& config );
+			virtual ~SQLiteShard( );
+
+			inline sqlite3* getDb( ) const {
+				return db;
+			}
+			inline const std::string& getFilename( ) const {
+				return filename;
+			}
+			inline bool isReadOnly( ) const {
+				return readOnly;
+			}
+			inline bool hasTx( ) const {
+				return tx;
+			}
+			sqlite3* acquireReader( );
+			void releaseReader( sqlite3* reader );
+
+			void txBegin();
+			void txCommit();
+			void txRollback();
+			void txWritten( const void* writer, int cells, size_t size );
+			void txFlush( const void* writer );
+			void txCommitExpired( );
+
+			void dropTable( int64_t id );
+			void drop( );
+			void close( );
+
+			class Lock {
+
+				public:
+
+					inline Lock( SQLiteShard* _shard )
+					: shard( _shard ) {
+						shard->lock();
+					}
+					inline ~Lock( ) {
+						shard->unlock();
+					}
+
+				private:
+
+					SQLiteShard* shard;
+			};
+			friend class Lock;
+			friend class SQLiteEnv;
+
+		private:
+
+			inline void lock( ) {
+				::EnterCriticalSection( &cs );
+			}
+			inline void unlock( ) {
+				::LeaveCriticalSection( &cs );
+			}
+
+			void prepareTx( );
+			void finalizeTx( );
+			bool txExpired( ) const;
+
+			std::string filename;
+			sqlite3* db;
+			bool readOnly;
+			bool dropped;
+			int autoVacuum;
+			bool tx;
+			int txCells;
+			size_t txBytes;
+			ULONGLONG txStart;
+			std::set<const void*> txWriters;
+
+			int commitCells;
+			size_t commitBytes;
+			DWORD commitInterval;
+			bool groupCommit;
+			int64_t mmapSize;
+
+			int maxReaders;
+			int readers;
+			std::vector<sqlite3*> readerPool;
+
+			sqlite3_stmt* stmtBegin;
+			sqlite3_stmt* stmtCommit;
+			sqlite3_stmt* stmtRollback;
+
+			CRITICAL_SECTION cs;
+			CRITICAL_SECTION csReaders;
+	};
+	typedef boost::intrusive_ptr<SQLiteShard> SQLiteShardPtr;
+
+	typedef SQLiteShard::Lock SQLiteShardLock;
+
 	/// <summary>
 	/// Represents the Hypertable sqlite environment.
 	/// </summary>
@@ -58,12 +160,18 @@ namespace ht4c { namespace SQLite {
 			inline sqlite3* getDb( ) const {
 				return db;
 			}
+			inline SQLiteShard* getShard( ) const {
+				return main.get();
+			}
 			inline bool UniqueRows( ) const {
 				return uniqueRows;
 			}
 			inline bool NoCellRevisions( ) const {
 				return noCellRevisions;
 			}
+			sqlite3_stmt* stmtAcquire( sqlite3* db, int64_t tableId, const std::string& sql );
+			void stmtRelease( sqlite3* db, int64_t tableId, const std::string& sql, sqlite3_stmt* stmt );
+			void stmtPurge( int64_t tableId );
 
 			void txBegin();
 			void txCommit();
@@ -77,7 +185,7 @@ namespace ht4c { namespace SQLite {
 			bool sysDbDelete( const char* name, int len, int64_t* rowid = 0 );
 
 			void sysDbCreateTable( const char* name, int len, const void* value, int size, int64_t& id );
-			bool sysDbOpenTable( Db::Table* table, int64_t& id );
+			bool sysDbOpenTable( Db::Table* table, int64_t& id, SQLiteShardPtr& shard );
 			bool sysDbRefreshTable( Db::Table* table );
 			void sysDbRefreshTable( int64_t id );
 			void sysDbDisposeTable( int64_t id );
@@ -100,31 +208,55 @@ namespace ht4c { namespace SQLite {
 					SQLiteEnv* env;
 			};
 			friend class Lock;
+			friend class SQLiteShard;
 
 		private:
 
+			// the environment lock includes the main shard, sys_db shares its writer connection
 			inline void lock( ) {
 				::EnterCriticalSection( &cs );
+				main->lock();
 			}
 			inline void unlock( ) {
+				main->unlock();
 				::LeaveCriticalSection( &cs );
 			}
 
+			SQLiteShardPtr shardOf( int64_t id );
+			std::string shardKey( int64_t id ) const;
+
+			static VOID CALLBACK commitTimerProc( void* param, BOOLEAN timerOrWaitFired );
+			static VOID CALLBACK checkpointTimerProc( void* param, BOOLEAN timerOrWaitFired );
+			void purge( );
+			bool purgeTable( SQLiteShard* shard, int64_t id, const std::string& schemaSpec );
+			bool purgeCells( SQLiteShard* shard, const std::string& sql, int cf, int64_t ts );
+			static VOID CALLBACK purgeTimerProc( void* param, BOOLEAN timerOrWaitFired );
+			static int registerFunctions( sqlite3* db );
+			static void regexp( sqlite3_context* ctx, int argc, sqlite3_value** argv );
+			static void regexpDelete( void* re );
+
+			SQLiteShardPtr main;
 			sqlite3* db;
 			bool readOnly;
-			bool tx;
+			HANDLE commitTimer;
+
+			sqlite3* checkpointDb;
+			HANDLE checkpointTimer;
+
+			int purgeBatchCells;
+			bool purgeVersions;
+			HANDLE purgeTimer;
+			volatile LONG purging;
 
-			int autoVacuum;
 			bool uniqueRows;
 			bool noCellRevisions;
+			bool withoutRowId;
+			bool shardPerTable;
 			bool indexColumn;
 			bool indexColumnFamily;
 			bool indexColumnQualifier;
 			bool indexTimestamp;
 
-			sqlite3_stmt* stmtBegin;
-			sqlite3_stmt* stmtCommit;
-			sqlite3_stmt* stmtRollback;
 			sqlite3_stmt* stmtInsert;
 			sqlite3_stmt* stmtUpdateKey;
 			sqlite3_stmt* stmtUpdateValue;
@@ -135,7 +267,21 @@ namespace ht4c { namespace SQLite {
 			typedef std::unordered_map<int64_t, std::set<Db::Table*>> tables_t;
 			tables_t tables;
 
+			typedef std::map<int64_t, SQLiteShardPtr> shards_t;
+			shards_t shards;
+
+			std::string filename;
+			std::unique_ptr<SQLiteEnvConfig> shardConfig;
+
+			typedef std::map<std::pair<int64_t, std::string>, std::vector<sqlite3_stmt*>> stmts_t;
+			typedef std::map<sqlite3*, stmts_t> stmt_cache_t;
+			stmt_cache_t stmtCache;
+			enum {
+				MAX_CACHED_STMTS = 16
+			};
+
 			CRITICAL_SECTION cs;
+			CRITICAL_SECTION csStmtCache;
 	};
 	typedef boost::intrusive_ptr<SQLiteEnv> SQLiteEnvPtr;
 
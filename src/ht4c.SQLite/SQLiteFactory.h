@@ -38,10 +38,24 @@ namespace ht4c { namespace SQLite {
 		int cacheSizeMB;
 		int pageSizeKB;
 		bool writeAheadLog;
+		int readConnections;
+		int commitCells;
+		int commitSizeMB;
+		int commitIntervalMsec;
+		bool groupCommit;
+		int mmapSizeMB;
+		int walAutoCheckpoint;
+		int checkpointIntervalMsec;
+		int purgeIntervalMsec;
+		int purgeBatchCells;
+		bool purgeVersions;
+		bool cacheSpill;
 		bool synchronous;
 		int autoVacuum; //0=None, 1=FULL, 2=INCREMENTAL
 		bool uniqueRows;
 		bool noCellRevisions;
+		bool withoutRowId;
+		bool shardPerTable;
 		bool indexColumn;
 		bool indexColumnFamily;
 		bool indexColumnQualifier;
@@ -51,10 +65,24 @@ namespace ht4c { namespace SQLite {
 			: cacheSizeMB( 64 )
 			, pageSizeKB( 4 )
 			, writeAheadLog( false )
+			, readConnections( 4 )
+			, commitCells( 100000 )
+			, commitSizeMB( 64 )
+			, commitIntervalMsec( 1000 )
+			, groupCommit( false )
+			, mmapSizeMB( 0 )
+			, walAutoCheckpoint( 1000 )
+			, checkpointIntervalMsec( 0 )
+			, purgeIntervalMsec( 60000 )
+			, purgeBatchCells( 1000 )
+			, purgeVersions( false )
+			, cacheSpill( true )
 			, synchronous( false )
 			, autoVacuum( 0 )
 			, uniqueRows( false )
 			, noCellRevisions( false )
+			, withoutRowId( false )
+			, shardPerTable( false )
 			, indexColumn( false )
 			, indexColumnFamily( false )
 			, indexColumnQualifier( false )
@@ -65,15 +65,20 @@ namespace ht4c { namespace SQLite {
 	}
 
 	Common::AsyncTableMutator* SQLiteTable::createAsyncMutator( Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t flags ) {
-		/*HT4C_TRY {
-			SQLiteEnvLock sync( table->getEnv() );
-			TODO Hypertable::SQLiteGen::Future future = typeid(asyncResult) != typeid(SQLiteBlockingAsyncResult)
-																					 ? static_cast<SQLiteAsyncResult&>(asyncResult).get(env)
-																					 : static_cast<SQLiteBlockingAsyncResult&>(asyncResult).get(env);
-			return SQLiteAsyncTableMutator::create( table->async_createMutator(future, flags) );
+		HT4C_TRY {
+			Db::FuturePtr future = typeid(asyncResult) != typeid(SQLiteBlockingAsyncResult)
+													 ? static_cast<SQLiteAsyncResult&>(asyncResult).get(table->getEnv())
+													 : static_cast<SQLiteBlockingAsyncResult&>(asyncResult).get(table->getEnv());
+
+			Db::MutatorAsyncPtr tableMutator;
+			{
+				SQLiteEnvLock sync( table->getEnv() );
+				tableMutator = table->createMutatorAsync( future, flags );
+			}
+			asyncResult.attachAsyncMutator( SQLiteAsyncTableMutator::id(tableMutator) );
+			return SQLiteAsyncTableMutator::create( tableMutator );
 		}
-		HT4C_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_SQLITE_RETHROW
 	}
 
 	Common::TableScanner* SQLiteTable::createScanner( Common::ScanSpec& scanSpec, uint32_t /*timeoutMsec*/, uint32_t flags ) {
@@ -84,34 +89,19 @@ namespace ht4c { namespace SQLite {
 		HT4C_SQLITE_RETHROW
 	}
 
-	Common::AsyncTableScanner* SQLiteTable::createAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t /*flags*/ ) {
-		/*HT4C_TRY {
-			Hypertable::SQLiteGen::ScanSpec _scanSpec;
-			convertScanSpec( scanSpec, _scanSpec );
-			SQLiteEnvLock sync( table->getEnv() );
-			Hypertable::SQLiteGen::Future future = typeid(asyncResult) != typeid(SQLiteBlockingAsyncResult)
-																					 ? static_cast<SQLiteAsyncResult&>(asyncResult).get(env)
-																					 : static_cast<SQLiteBlockingAsyncResult&>(asyncResult).get(env);
-
-			return SQLiteAsyncTableScanner::create( table->async_createScanner(future, _scanSpec) );
+	Common::AsyncTableScanner* SQLiteTable::createAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t flags ) {
+		HT4C_TRY {
+			return SQLiteAsyncTableScanner::create( startAsyncScanner(scanSpec, asyncResult, flags) );
 		}
-		HT4C_SQLITE_RETHROW */
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_SQLITE_RETHROW
 	}
 
-	int64_t SQLiteTable::createAsyncScannerId( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t /*flags*/ ) {
-		/*HT4C_TRY {
-			Hypertable::SQLiteGen::ScanSpec _scanSpec;
-			convertScanSpec( scanSpec, _scanSpec );
-			SQLiteEnvLock sync( table->getEnv() );
-			Hypertable::SQLiteGen::Future future = typeid(asyncResult) != typeid(SQLiteBlockingAsyncResult)
-																					 ? static_cast<SQLiteAsyncResult&>(asyncResult).get(env)
-																					 : static_cast<SQLiteBlockingAsyncResult&>(asyncResult).get(env);
-
-			return SQLiteAsyncTableScanner::id( env->async_createScanner(ns, name, future, _scanSpec) );
+	int64_t SQLiteTable::createAsyncScannerId( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t /*timeoutMsec*/, uint32_t flags ) {
+		HT4C_TRY {
+			// the worker holds a reference to the scanner until the scan has been completed or cancelled
+			return SQLiteAsyncTableScanner::id( startAsyncScanner(scanSpec, asyncResult, flags) );
 		}
-		HT4C_SQLITE_RETHROW*/
-		HT4C_THROW_NOTIMPLEMENTED();
+		HT4C_SQLITE_RETHROW
 	}
 
 	std::string SQLiteTable::getSchema( bool withIds ) {
@@ -124,6 +114,29 @@ namespace ht4c { namespace SQLite {
 		HT4C_SQLITE_RETHROW
 	}
 
+	Db::ScannerAsyncPtr SQLiteTable::startAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t flags ) {
+		Db::FuturePtr future = typeid(asyncResult) != typeid(SQLiteBlockingAsyncResult)
+												 ? static_cast<SQLiteAsyncResult&>(asyncResult).get(table->getEnv())
+												 : static_cast<SQLiteBlockingAsyncResult&>(asyncResult).get(table->getEnv());
+
+		Db::ScannerAsyncPtr tableScanner;
+		{
+			SQLiteEnvLock sync( table->getEnv() );
+			tableScanner = table->createScannerAsync( scanSpec.get(), future, flags );
+		}
+
+		// attach before the first results get published
+		asyncResult.attachAsyncScanner( SQLiteAsyncTableScanner::id(tableScanner) );
+		try {
+			tableScanner->start();
+		}
+		catch( ... ) {
+			asyncResult.cancelAsyncScanner( SQLiteAsyncTableScanner::id(tableScanner) );
+			throw;
+		}
+		return tableScanner;
+	}
+
 	SQLiteTable::SQLiteTable( Db::TablePtr _table )
 	: table( _table )
 	{
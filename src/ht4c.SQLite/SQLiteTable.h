@@ -83,6 +83,8 @@ namespace ht4c { namespace SQLite {
 			SQLiteTable( const SQLiteTable& ) { }
 			SQLiteTable& operator = ( const SQLiteTable& ) { return *this; }
 
+			Db::ScannerAsyncPtr startAsyncScanner( Common::ScanSpec& scanSpec, Common::AsyncResult& asyncResult, uint32_t flags );
+
 			Db::TablePtr table;
 	};
 
@@ -42,7 +42,7 @@ namespace ht4c { namespace SQLite {
 	SQLiteTableMutator::~SQLiteTableMutator( ) {
 		HT4C_TRY {
 			{
-				SQLiteEnvLock sync( tableMutator->getEnv() );
+				SQLiteShardLock sync( tableMutator->getShard() );
 				tableMutator->flush( );
 			}
 			tableMutator = 0;
@@ -54,7 +54,7 @@ namespace ht4c { namespace SQLite {
 		HT4C_TRY {
 			flag = FLAG( columnFamily, columnQualifier, flag );
 			Hypertable::KeySpec keySpec( row, CF(columnFamily), columnQualifier, TIMESTAMP(timestamp, flag), flag );
-			SQLiteEnvLock sync( tableMutator->getEnv() );
+			SQLiteShardLock sync( tableMutator->getShard() );
 			tableMutator->set( keySpec, value, valueLength );
 		}
 		HT4C_SQLITE_RETHROW
@@ -64,7 +64,7 @@ namespace ht4c { namespace SQLite {
 		HT4C_TRY {
 			row = Common::KeyBuilder();
 			Hypertable::KeySpec keySpec( row.c_str(), CF(columnFamily), columnQualifier, TIMESTAMP(timestamp, Hypertable::FLAG_INSERT) );
-			SQLiteEnvLock sync( tableMutator->getEnv() );
+			SQLiteShardLock sync( tableMutator->getShard() );
 			tableMutator->set( keySpec, value, valueLength );
 		}
 		HT4C_SQLITE_RETHROW
@@ -72,7 +72,7 @@ namespace ht4c { namespace SQLite {
 
 	void SQLiteTableMutator::set( const Common::Cells& cells ) {
 		HT4C_TRY {
-			SQLiteEnvLock sync( tableMutator->getEnv() );
+			SQLiteShardLock sync( tableMutator->getShard() );
 			tableMutator->set( cells.get() );
 		}
 		HT4C_SQLITE_RETHROW
@@ -82,7 +82,7 @@ namespace ht4c { namespace SQLite {
 		HT4C_TRY {
 			uint8_t flag = FLAG_DELETE( columnFamily, columnQualifier );
 			Hypertable::KeySpec keySpec( row, CF(columnFamily), columnQualifier, TIMESTAMP(timestamp, flag), flag );
-			SQLiteEnvLock sync( tableMutator->getEnv() );
+			SQLiteShardLock sync( tableMutator->getShard() );
 			tableMutator->del( keySpec );
 		}
 		HT4C_RETHROW
@@ -90,7 +90,7 @@ namespace ht4c { namespace SQLite {
 
 	void SQLiteTableMutator::flush() {
 		HT4C_TRY {
-			SQLiteEnvLock sync( tableMutator->getEnv() );
+			SQLiteShardLock sync( tableMutator->getShard() );
 			tableMutator->flush( );
 		}
 		HT4C_SQLITE_RETHROW
@@ -84,6 +84,14 @@ namespace ht4c { namespace SQLite { namespace Db { namespace Util {
 		return cq ? cq : "";
 	}
 
+	inline size_t CellSize( const Hypertable::Cell& cell ) {
+		return sizeof(Hypertable::Cell)
+				 + strlen( cell.row_key )
+				 + (cell.column_family ? strlen(cell.column_family) : 0)
+				 + (cell.column_qualifier ? strlen(cell.column_qualifier) : 0)
+				 + cell.value_len;
+	}
+
 	static void stmt_finalize( sqlite3* db, sqlite3_stmt** stmt ) {
 		if( *stmt ) {
 			sqlite3_clear_bindings( *stmt );